@@ -233,6 +233,12 @@ async function loadData() {
         if (!preferences.sensors) {
             preferences.sensors = {};
         }
+        if (!preferences.resolutions) {
+            preferences.resolutions = {};
+        }
+        if (!preferences.filters) {
+            preferences.filters = {};
+        }
         updateSensorList(sensors, preferences);
 
     } catch (error) {
@@ -243,6 +249,32 @@ async function loadData() {
 /**
  * Sensor Management
  */
+const SENSOR_RESOLUTIONS = [
+    { bits: 9, label: '9 bit (0.5°C, 94 ms)' },
+    { bits: 10, label: '10 bit (0.25°C, 188 ms)' },
+    { bits: 11, label: '11 bit (0.125°C, 375 ms)' },
+    { bits: 12, label: '12 bit (0.0625°C, 750 ms)' }
+];
+
+function resolutionOptions(selected) {
+    return SENSOR_RESOLUTIONS.map(r =>
+        `<option value="${r.bits}" ${r.bits === selected ? 'selected' : ''}>${r.label}</option>`
+    ).join('');
+}
+
+const SENSOR_FILTERS = [
+    { type: 'none', label: 'No filter' },
+    { type: 'median', label: 'Median (5 samples)' },
+    { type: 'ema', label: 'Moving average' },
+    { type: 'kalman', label: 'Kalman (spike rejection)' }
+];
+
+function filterOptions(selected) {
+    return SENSOR_FILTERS.map(f =>
+        `<option value="${f.type}" ${f.type === selected ? 'selected' : ''}>${f.label}</option>`
+    ).join('');
+}
+
 function updateSensorList(sensors, preferences) {
     const sensorList = document.getElementById('sensorList');
     const displaySelect = document.getElementById('display.selectedSensor');
@@ -277,6 +309,14 @@ function updateSensorList(sensors, preferences) {
                            value="${preferences.sensors[sensor.address] || ''}"
                            placeholder="Sensor ${sensor.address.slice(-4)}"
                            class="flex-1 rounded-md border-gray-300 shadow-sm focus:border-blue-500 focus:ring-blue-500">
+                    <select name="resolution-${sensor.address}"
+                            class="rounded-md border-gray-300 shadow-sm focus:border-blue-500 focus:ring-blue-500">
+                        ${resolutionOptions(preferences.resolutions[sensor.address] || 12)}
+                    </select>
+                    <select name="filter-${sensor.address}"
+                            class="rounded-md border-gray-300 shadow-sm focus:border-blue-500 focus:ring-blue-500">
+                        ${filterOptions(preferences.filters[sensor.address] || 'none')}
+                    </select>
                 </div>
                 <div class="mt-1 text-sm text-gray-500">
                     ID: ${sensor.address}
@@ -315,6 +355,8 @@ function collectFormData() {
             displayTimeout: 30
         },
         sensors: {},
+        resolutions: {},
+        filters: {},
         relays: []
     };
 
@@ -332,6 +374,20 @@ function collectFormData() {
         }
     });
 
+    // Collect sensor resolutions
+    const resolutionSelects = document.querySelectorAll('select[name^="resolution-"]');
+    resolutionSelects.forEach(select => {
+        const address = select.name.replace('resolution-', '');
+        formData.resolutions[address] = parseInt(select.value);
+    });
+
+    // Collect sensor filters
+    const filterSelects = document.querySelectorAll('select[name^="filter-"]');
+    filterSelects.forEach(select => {
+        const address = select.name.replace('filter-', '');
+        formData.filters[address] = select.value;
+    });
+
     // Collect relay names
     for (let i = 0; i < 2; i++) {
         const name = document.getElementById(`relay-${i}-name`).value.trim();
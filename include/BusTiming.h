@@ -0,0 +1,89 @@
+// include/BusTiming.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Log2 latency histogram in microseconds. Bucket 0 counts samples below 1 us,
+// bucket n counts samples in [2^(n-1), 2^n) us; the last bucket is open-ended.
+struct LatencyHistogram {
+    static constexpr uint8_t BUCKETS = 20;   // Last bucket starts at ~262 ms
+    
+    uint32_t counts[BUCKETS];
+    uint32_t samples;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    
+    void record(uint32_t us) {
+        uint8_t bucket = 0;
+        while (bucket < BUCKETS - 1 && (us >> bucket) != 0) {
+            bucket++;
+        }
+        counts[bucket]++;
+        samples++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+    
+    uint32_t meanUs() const {
+        return samples ? static_cast<uint32_t>(totalUs / samples) : 0;
+    }
+};
+
+enum class BusOperation : uint8_t {
+    RESET,          // Reset pulse and presence detect
+    SEARCH,         // One ROM found by SEARCH ROM
+    ALARM_SEARCH,   // One ROM found by ALARM SEARCH
+    CONVERT,        // Reset + ROM command + CONVERT T
+    SCRATCHPAD,     // Complete scratchpad read of one sensor
+    CRC_RETRY,      // Immediate re-read after a CRC failure
+    COUNT
+};
+
+// Bus accounting for one collection pass
+struct CycleStats {
+    uint16_t resets;        // Reset/presence sequences issued
+    uint32_t bitSlots;      // Read/write time slots issued
+    uint32_t busTimeUs;     // Time spent talking to the bus
+    uint32_t lockTimeUs;    // Time sensorMutex was held
+    uint8_t crcErrors;      // Scratchpads rejected by CRC
+    uint8_t inBand;         // Sensors skipped by alarm search
+};
+
+// Per-bus timing of every transaction type. A collection pass counts as
+// preempted when another task ran on the bus task's core before it finished.
+// Without run-time stats in the FreeRTOS build nothing can be measured, which
+// preemptionMeasured tells apart from zero preemptions.
+struct BusTiming {
+    LatencyHistogram ops[static_cast<size_t>(BusOperation::COUNT)];
+    uint32_t passes;            // Collection passes
+    uint32_t preemptedPasses;
+    bool preemptionMeasured;
+    
+    void record(BusOperation op, uint32_t us) {
+        ops[static_cast<size_t>(op)].record(us);
+    }
+    
+    // Task run-time counter before and after the pass's bus transactions
+    void recordPass(uint32_t runTimeBefore, uint32_t runTimeAfter) {
+        passes++;
+        if (runTimeAfter != 0) preemptionMeasured = true;
+        if (runTimeAfter != runTimeBefore) preemptedPasses++;
+    }
+    
+    const LatencyHistogram& get(BusOperation op) const {
+        return ops[static_cast<size_t>(op)];
+    }
+    
+    static const char* operationName(BusOperation op) {
+        switch (op) {
+            case BusOperation::RESET:      return "reset";
+            case BusOperation::SEARCH:     return "search";
+            case BusOperation::ALARM_SEARCH: return "alarmSearch";
+            case BusOperation::CONVERT:    return "convert";
+            case BusOperation::SCRATCHPAD: return "scratchpad";
+            case BusOperation::CRC_RETRY:  return "crcRetry";
+            default:                       return "unknown";
+        }
+    }
+};
@@ -31,20 +31,80 @@
 #define DNS_CACHE_TIME 300000  // 5 minutes
 
 // Task configurations
+// Topology: the OneWire bus tasks bit-bang 1-Wire slots and run on the
+// application core (1) above everything else there. Network, TLS and control
+// work share the protocol core (0) with lwIP and the Ethernet driver, so a TLS
+// handshake can never preempt a bus transaction. AsyncTCP is placed by its own
+// build flags in platformio.ini. Any value can be overridden with -D.
 #define NETWORK_TASK_STACK_SIZE 8192
+#ifndef NETWORK_TASK_PRIORITY
 #define NETWORK_TASK_PRIORITY 2
+#endif
+#ifndef NETWORK_TASK_CORE
+#define NETWORK_TASK_CORE 0
+#endif
 #define ONEWIRE_TASK_STACK_SIZE 4096
-#define ONEWIRE_TASK_PRIORITY 2
+#ifndef ONEWIRE_TASK_PRIORITY
+#define ONEWIRE_TASK_PRIORITY 5
+#endif
 #define CONTROL_TASK_STACK_SIZE 4096
+#ifndef CONTROL_TASK_PRIORITY
 #define CONTROL_TASK_PRIORITY 2
+#endif
+#ifndef CONTROL_TASK_CORE
+#define CONTROL_TASK_CORE 0
+#endif
 
 // Pin Configuration
-constexpr uint8_t ONE_WIRE_BUS = 4;
+// One OneWire task runs per bus; buses convert and read independently.
+// Core affinity is per bus so bit-banged slots on one core do not stall the other.
+constexpr uint8_t ONE_WIRE_BUS_PINS[] = {4};
+constexpr uint8_t ONE_WIRE_BUS_CORES[] = {1};
+constexpr uint8_t ONE_WIRE_BUS_COUNT = sizeof(ONE_WIRE_BUS_PINS) / sizeof(ONE_WIRE_BUS_PINS[0]);
+static_assert(sizeof(ONE_WIRE_BUS_CORES) == sizeof(ONE_WIRE_BUS_PINS), 
+              "Every OneWire bus needs a core assignment");
+
+constexpr bool busCoresAvoid(int core, size_t bus = 0) {
+    return bus == ONE_WIRE_BUS_COUNT || 
+           (ONE_WIRE_BUS_CORES[bus] != core && busCoresAvoid(core, bus + 1));
+}
+static_assert(busCoresAvoid(NETWORK_TASK_CORE), 
+              "OneWire buses must not share a core with the network task");
+#ifdef CONFIG_ASYNC_TCP_RUNNING_CORE
+static_assert(busCoresAvoid(CONFIG_ASYNC_TCP_RUNNING_CORE), 
+              "OneWire buses must not share a core with AsyncTCP");
+#endif
+
+// Staggered conversions: each resolution group is split into this many slots by
+// table position. Slots start a fraction of the conversion time apart so one
+// slot is read while the next converts. Parasite-powered buses always use a
+// single broadcast, since any traffic cuts the supply of converting devices.
+constexpr uint8_t CONVERSION_STAGGER_GROUPS = 1;
+static_assert(CONVERSION_STAGGER_GROUPS >= 1 && CONVERSION_STAGGER_GROUPS <= 4,
+              "Between 1 and 4 stagger slots per resolution");
+
+// Alarm-search mode: each sensor's TH/TL registers are set around its last reading
+// and only sensors found by ALARM SEARCH are read, plus a periodic full refresh.
+// Changes smaller than the band can go unseen for up to the refresh interval.
+constexpr bool ONEWIRE_ALARM_SEARCH = false;
+constexpr int8_t ALARM_BAND_DEGREES = 1;                  // Whole degrees either side
+constexpr uint32_t ALARM_FULL_REFRESH_INTERVAL = 60000;   // Max age of a reading (ms)
+
+// Build with -DONEWIRE_SIMULATED_BUS to replace every bus with simulated DS18B20s
+#if defined(ONEWIRE_SIMULATED_BUS) && !defined(ONEWIRE_SIMULATED_SENSORS)
+#define ONEWIRE_SIMULATED_SENSORS 8                       // Devices per simulated bus
+#endif
+
+// Host builds keep preferences in a file instead of NVS
+#if !defined(ARDUINO) && !defined(PREFERENCES_FILE)
+#define PREFERENCES_FILE "preferences.bin"
+#endif
 
 // System Configuration
 #define CREDENTIAL_RESET_PIN 15  // GPIO15 from UEXT
 #define CREDENTIAL_RESET_TIME 10000  // 10 seconds hold time
-constexpr size_t MAX_ONEWIRE_SENSORS = 16;
+constexpr size_t MAX_ONEWIRE_SENSORS = 16;           // Per bus
+constexpr size_t MAX_TOTAL_SENSORS = MAX_ONEWIRE_SENSORS * ONE_WIRE_BUS_COUNT;
 constexpr uint32_t WATCHDOG_TIMEOUT = 30000;  // 30 seconds
 constexpr uint8_t MAX_RETRIES = 3;            // Maximum number of retry attempts
 
@@ -0,0 +1,80 @@
+// include/ConfigCache.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Config.h"
+#include "SharedDefinitions.h"
+#include "SensorMetadataTable.h"
+
+// Settings that change through PreferencesManager and are announced to
+// subscribers
+enum class ConfigKey : uint8_t {
+    DISPLAY_SENSOR,
+    AUTO_SCAN,
+    SCAN_INTERVAL,
+    RELAY_NAME,
+    MQTT,
+    SENSOR_NAME,
+    SENSOR_RESOLUTION,
+    SENSOR_FILTER,
+    COUNT
+};
+
+// RAM copy of the settings PreferencesManager serves to hot paths. One writer
+// at a time (PreferencesManager holds its mutex); readers take no lock and
+// retry if a write overlapped their copy, as in SensorRegistry.
+//
+// Everything is loaded at init; per-sensor settings are the metadata table,
+// which is read and written as one blob.
+struct ConfigCache {
+    static constexpr uint8_t RELAY_COUNT = 2;
+
+    // Bits of a dirty mask: the global settings use their ConfigKey, and any
+    // SENSOR_* bit means the metadata table needs writing
+    static constexpr uint32_t dirtyBit(ConfigKey key) { return 1UL << static_cast<uint8_t>(key); }
+    static constexpr uint32_t SENSOR_BITS = (1UL << static_cast<uint8_t>(ConfigKey::SENSOR_NAME)) |
+                                            (1UL << static_cast<uint8_t>(ConfigKey::SENSOR_RESOLUTION)) |
+                                            (1UL << static_cast<uint8_t>(ConfigKey::SENSOR_FILTER));
+
+    std::atomic<uint32_t> seq{0};           // Odd while being written
+
+    uint8_t displaySensor[8];
+    bool autoScan;
+    uint32_t scanInterval;
+    char relayNames[RELAY_COUNT][MAX_SENSOR_NAME_LENGTH];
+    char mqttServer[MAX_MQTT_SERVER_LENGTH];
+    uint16_t mqttPort;
+    char mqttUsername[MAX_MQTT_CRED_LENGTH];
+    char mqttPassword[MAX_MQTT_CRED_LENGTH];
+    SensorMetadataTable sensors;
+
+    uint32_t dirty;                         // Settings still to be written
+    uint8_t dirtyRelays;                    // Bit per relay name
+
+    // fn copies out of the cache and may run more than once
+    template <typename Fn>
+    void read(Fn&& fn) const {
+        while (true) {
+            uint32_t before = seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                fn(*this);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) == before) return;
+            }
+            taskYIELD();
+        }
+    }
+
+    // Caller must be the only writer
+    template <typename Fn>
+    void write(Fn&& fn) {
+        seq.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fn(*this);
+        seq.fetch_add(1, std::memory_order_release);
+    }
+};
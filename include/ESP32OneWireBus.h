@@ -0,0 +1,25 @@
+// include/ESP32OneWireBus.h
+#pragma once
+
+#include <OneWire.h>
+#include "OneWireBus.h"
+
+// Bit-banged bus on a GPIO pin using the OneWire library
+class ESP32OneWireBus : public OneWireBus {
+public:
+    explicit ESP32OneWireBus(uint8_t pin) : pin(pin), oneWire(pin) {}
+
+    void begin() override;
+    bool reset() override;
+    void select(const uint8_t* rom) override;
+    void skip() override;
+    void write(uint8_t value, bool power) override;
+    uint8_t read() override;
+    uint8_t readBit() override;
+    void resetSearch() override;
+    bool search(uint8_t* rom, bool alarmOnly) override;
+
+private:
+    uint8_t pin;
+    OneWire oneWire;
+};
@@ -18,6 +18,8 @@ public:
     bool putUInt(const char* key, uint32_t value) override;
     uint32_t getUInt(const char* key, uint32_t defaultValue) override;
     bool remove(const char* key) override;
+    size_t putBytes(const char* key, const void* value, size_t len) override;
+    size_t getBytes(const char* key, void* buffer, size_t maxLen) override;
 
 private:
     Preferences prefs;
@@ -0,0 +1,105 @@
+// include/FilePreferenceStorage.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "PreferenceStorage.h"
+
+// Preference storage in a memory-mapped file, for host builds. Mirrors the
+// NVS rules PreferencesManager relies on: namespaces, 15 character keys,
+// typed values that read back as the default under another type, and blobs
+// that fail to read into a short buffer. Latency and write failures can be
+// injected, and every key counts its writes across runs to estimate flash
+// wear. Only available where ARDUINO is not defined.
+class FilePreferenceStorage : public PreferenceStorage {
+public:
+    static constexpr size_t KEY_SIZE = 16;          // NVS limit, including the terminator
+    static constexpr size_t MAX_VALUE_SIZE = 4000;  // Largest NVS string
+    static constexpr size_t SLOT_COUNT = 128;
+
+    struct Faults {
+        uint32_t readLatencyUs = 0;
+        uint32_t writeLatencyUs = 0;
+        float writeFailureRate = 0.0f;      // Chance a put or remove fails and changes nothing
+    };
+
+    // Activity since construction or resetCounters()
+    struct Counters {
+        uint32_t reads;
+        uint32_t writes;
+        uint32_t redundantWrites;           // Writes of the value already stored
+        uint32_t failedWrites;
+        uint32_t removes;
+        uint64_t bytesWritten;
+    };
+
+    struct KeyWear {
+        char key[KEY_SIZE];
+        uint32_t writes;                    // Since the file was created
+    };
+
+    explicit FilePreferenceStorage(const char* path, uint32_t seed = 1);
+    ~FilePreferenceStorage() override;
+
+    bool begin(const char* name, bool readOnly) override;
+    bool putString(const char* key, const char* value) override;
+    String getString(const char* key, const char* defaultValue) override;
+    bool putUInt(const char* key, uint32_t value) override;
+    uint32_t getUInt(const char* key, uint32_t defaultValue) override;
+    bool remove(const char* key) override;
+    size_t putBytes(const char* key, const void* value, size_t len) override;
+    size_t getBytes(const char* key, void* buffer, size_t maxLen) override;
+
+    void setFaults(const Faults& newFaults) { faults = newFaults; }
+    const Counters& getCounters() const { return counters; }
+    void resetCounters() { counters = {}; }
+
+    // Writes of one key, or of every key, in the current namespace
+    uint32_t getWear(const char* key) const;
+    size_t getWear(KeyWear* out, size_t maxKeys) const;
+
+private:
+    static constexpr uint32_t MAGIC = 0x53465250;   // "PRFS"
+    static constexpr uint16_t VERSION = 1;
+
+    enum class Type : uint8_t { UNUSED, FREE, UINT, STRING, BLOB };
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t slotCount;
+    };
+
+    // A removed key keeps its slot, and so its write count, until the slot
+    // is needed for another key
+    struct Slot {
+        char ns[KEY_SIZE];
+        char key[KEY_SIZE];
+        Type type;
+        uint8_t reserved;
+        uint16_t length;
+        uint32_t writes;
+        uint8_t data[MAX_VALUE_SIZE];
+    };
+
+    static constexpr size_t FILE_SIZE = sizeof(Header) + SLOT_COUNT * sizeof(Slot);
+
+    bool map();
+    void unmap();
+    Slot* slotAt(size_t index) const;
+    Slot* find(const char* key) const;
+    bool write(const char* key, Type type, const void* value, size_t len);
+    bool validKey(const char* key) const;
+    uint32_t nextRandom();
+    bool chance(float probability);
+    void sleepUs(uint32_t us) const;
+
+    char path[256];
+    int fd;
+    uint8_t* base;
+    char ns[KEY_SIZE];
+    bool readOnly;
+    Faults faults;
+    Counters counters;
+    uint32_t rng;
+};
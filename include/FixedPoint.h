@@ -0,0 +1,61 @@
+// include/FixedPoint.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Temperatures travel through the firmware as int16 counts of 1/16 C, the
+// native DS18x20 unit. Every serializer prints from that value with the
+// formatter below instead of going through float.
+namespace FixedPoint {
+    constexpr int16_t RAW_PER_DEGREE = 16;
+    constexpr int16_t RAW_DISCONNECTED = -127 * RAW_PER_DEGREE;  // DEVICE_DISCONNECTED_C
+    constexpr size_t TEMP_BUFFER_SIZE = 12;   // "-2048.0000" plus terminator
+    constexpr uint8_t STATE_DECIMALS = 1;     // MQTT state topics and the display
+    constexpr uint8_t JSON_DECIMALS = 2;      // Web API and ThingsBoard telemetry
+    
+    inline float toCelsius(int16_t raw) {
+        return raw / (float)RAW_PER_DEGREE;
+    }
+    
+    // Print raw with 0-4 decimals, rounded half away from zero. buf must hold
+    // TEMP_BUFFER_SIZE bytes. Returns the length written.
+    inline size_t formatTemperature(int16_t raw, uint8_t decimals, char* buf) {
+        static constexpr uint32_t POW10[] = {1, 10, 100, 1000, 10000};
+        if (decimals > 4) decimals = 4;
+        
+        bool negative = raw < 0;
+        uint32_t magnitude = negative ? -(int32_t)raw : raw;
+        uint32_t scaled = (magnitude * POW10[decimals] + RAW_PER_DEGREE / 2) / RAW_PER_DEGREE;
+        uint32_t whole = scaled / POW10[decimals];
+        uint32_t frac = scaled % POW10[decimals];
+        
+        char* p = buf;
+        if (negative && scaled != 0) *p++ = '-';
+        
+        char digits[5];
+        uint8_t n = 0;
+        do {
+            digits[n++] = '0' + whole % 10;
+            whole /= 10;
+        } while (whole);
+        while (n) *p++ = digits[--n];
+        
+        if (decimals) {
+            *p++ = '.';
+            for (int8_t d = decimals - 1; d >= 0; d--) {
+                p[d] = '0' + frac % 10;
+                frac /= 10;
+            }
+            p += decimals;
+        }
+        *p = '\0';
+        return p - buf;
+    }
+    
+    // Tenths of a degree, rounded half away from zero
+    inline int16_t toTenths(int16_t raw) {
+        int32_t tenths = (int32_t)raw * 10;
+        return (tenths + (raw < 0 ? -RAW_PER_DEGREE / 2 : RAW_PER_DEGREE / 2)) / RAW_PER_DEGREE;
+    }
+}
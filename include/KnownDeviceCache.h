@@ -0,0 +1,51 @@
+// include/KnownDeviceCache.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Config.h"
+#include "SharedDefinitions.h"
+
+// Last known devices of one bus, stored as a single NVS blob so a reboot can
+// start converting before the bus has been searched. Only count entries are
+// stored.
+struct KnownDeviceCache {
+    static constexpr uint8_t VERSION = 1;
+
+    struct Entry {
+        uint8_t rom[8];
+        uint8_t resolution;
+        uint8_t filter;                         // FilterType
+        char name[MAX_SENSOR_NAME_LENGTH];
+    };
+
+    uint8_t version;
+    uint8_t count;
+    Entry entries[MAX_ONEWIRE_SENSORS];
+
+    static constexpr size_t HEADER_SIZE = 2;
+
+    size_t size() const {
+        return HEADER_SIZE + count * sizeof(Entry);
+    }
+
+    // Blob of len bytes read back from storage
+    bool isValid(size_t len) const {
+        return len >= HEADER_SIZE && version == VERSION &&
+               count <= MAX_ONEWIRE_SENSORS && len == size();
+    }
+
+    const Entry* find(const uint8_t* rom) const {
+        for (uint8_t i = 0; i < count; i++) {
+            bool match = true;
+            for (uint8_t b = 0; b < 8 && match; b++) {
+                match = entries[i].rom[b] == rom[b];
+            }
+            if (match) return &entries[i];
+        }
+        return nullptr;
+    }
+};
+
+static_assert(offsetof(KnownDeviceCache, entries) == KnownDeviceCache::HEADER_SIZE,
+              "Cache entries follow the header directly");
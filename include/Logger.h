@@ -35,14 +35,24 @@ public:
     static void debug(const String& message, Category category = Category::GENERAL);
     static void trace(const String& message, Category category = Category::GENERAL);
     
+    // printf-style message formatted on the stack, for paths that must not
+    // touch the heap; longer messages are cut at LOGF_BUFFER_SIZE
+    static void logf(Level level, Category category, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
+    
+    // Whether a message would be printed; guards messages that are expensive
+    // to build
+    static bool isEnabled(Level level, Category category = Category::GENERAL);
+    
 private:
     static Level currentLevel;                // Current logging level
     static uint8_t enabledCategories;         // Bitfield of enabled categories
     static unsigned long lastMemoryLog;       // Timestamp of last memory log
     static constexpr unsigned int MEMORY_LOG_INTERVAL = 5000;  // 5 seconds between memory logs
+    static constexpr size_t LOGF_BUFFER_SIZE = 128;
     
     // Internal helper methods
-    static void logMessage(Level level, Category category, const String& message);
+    static void logMessage(Level level, Category category, const char* message);
     static const char* getLevelString(Level level);
     static const char* getCategoryString(Category category);
     static bool isCategoryEnabled(Category category);
@@ -9,6 +9,8 @@
 
 class MDNSManager {
 public:
+    static constexpr uint32_t UPDATE_INTERVAL = 10000; // 10 second interval
+    
     static bool init();
     static void update();
     static bool isInitialized() { return initialized; }
@@ -17,6 +19,4 @@ public:
 
 private:
     static bool initialized;
-    static constexpr uint32_t UPDATE_INTERVAL = 10000; // 10 second interval
-    static uint32_t lastUpdate;
 };
@@ -21,6 +21,7 @@ public:
     void disconnect();
     bool isConnected() { return mqttClient.connected(); }
     bool maintainConnection();
+    uint32_t msUntilReconnect() const;  // Time until the next connect attempt is allowed
     
     // Publication methods
     bool publish(const char* topic, const char* payload, bool retained = false);
@@ -40,7 +41,7 @@ public:
     // State management
     void resetConnectionState();
     void publishBabelSensorMetadata();
-    void publishBabelSensorState(float temperature);
+    void publishBabelSensorState(int16_t temperatureRaw);
     String createBabelSensorTopic() const;
 
 private:
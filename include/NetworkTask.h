@@ -2,17 +2,57 @@
 #pragma once
 
 #include <Arduino.h>
+#include <WiFi.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "Config.h"
 #include "MqttManager.h"
+#include "PublishBuffer.h"
+#include "TimerWheel.h"
 
 class NetworkTask {
 public:
+    // Task notification bits; the task sleeps until one is set or a periodic
+    // duty is due
+    static constexpr uint32_t EVENT_SNAPSHOT = 1UL << 0;   // Sensor registry updated
+    static constexpr uint32_t EVENT_RELAY = 1UL << 1;      // Relay state changed
+    static constexpr uint32_t EVENT_LINK = 1UL << 2;       // Ethernet link up or down
+    static constexpr uint32_t EVENT_PUBLISH = 1UL << 3;    // Event message queued
+    
     static void init();
     static void start();
     static bool enqueuePublication(const TaskMessage& msg);
+    static void notify(uint32_t events);
+    static PublishBuffer::Counters getPublishCounters();
+    
+    // Owned by the task; read elsewhere only for statistics
+    static const TimerWheel& getTimers() { return timers; }
     
 private:
     static void taskFunction(void* parameter);
+    static void onNetworkEvent(WiFiEvent_t event);
+    static void drainPublishBuffer();
+    static void publishSnapshot(uint32_t now, bool refresh);
+    static void resetPublished();
+    
+    // What was last sent for each registry slot
+    struct PublishedSensor {
+        uint64_t key;           // ROM of the sensor in the slot, 0 if none
+        uint32_t readTime;      // lastReadTime of the published reading
+        uint32_t publishedAt;
+    };
+    
     static MqttManager mqttManager;
-    static QueueHandle_t publishQueue;
+    static PublishBuffer publishBuffer;
     static QueueHandle_t controlQueue;
+    static TaskHandle_t taskHandle;
+    static TimerWheel timers;
+    static PublishedSensor published[MAX_TOTAL_SENSORS];
+    static uint32_t publishedGeneration;
+    
+    static constexpr uint32_t MQTT_POLL_INTERVAL = 500;       // Incoming messages and keepalive
+    static constexpr uint32_t IDLE_WAIT = 60000;              // Longest sleep with no timer armed
+    static constexpr uint32_t NTP_RETRY_INTERVAL = 5000;
+    static constexpr uint32_t PUBLISH_INTERVAL = 30000;       // Full sensor and relay refresh
+    static constexpr uint32_t HAD_PUBLISH_INTERVAL = 300000;  // Discovery metadata
 };
@@ -0,0 +1,48 @@
+// include/OneWireBus.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-level access to one 1-Wire bus. OneWireManager only talks to the bus
+// through this interface, so the acquisition path can run against real
+// hardware (ESP32OneWireBus) or a simulated bus (SimulatedOneWireBus).
+class OneWireBus {
+public:
+    virtual ~OneWireBus() = default;
+
+    virtual void begin() {}
+
+    // Reset pulse; true when at least one device answered with presence
+    virtual bool reset() = 0;
+
+    // ROM commands following a reset
+    virtual void select(const uint8_t* rom) = 0;   // MATCH ROM
+    virtual void skip() = 0;                       // SKIP ROM
+
+    // Function commands and data. power keeps the strong pull-up on after the
+    // byte for parasite-powered devices.
+    virtual void write(uint8_t value, bool power = false) = 0;
+    virtual uint8_t read() = 0;
+    virtual uint8_t readBit() = 0;
+
+    // SEARCH ROM, or ALARM SEARCH when alarmOnly is set. Returns the next ROM
+    // until the bus is exhausted, then starts over after resetSearch().
+    virtual void resetSearch() = 0;
+    virtual bool search(uint8_t* rom, bool alarmOnly = false) = 0;
+
+    // Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1)
+    static uint8_t crc8(const uint8_t* data, size_t len) {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < len; i++) {
+            uint8_t byte = data[i];
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                uint8_t mix = (crc ^ byte) & 0x01;
+                crc >>= 1;
+                if (mix) crc ^= 0x8C;
+                byte >>= 1;
+            }
+        }
+        return crc;
+    }
+};
@@ -1,37 +1,115 @@
 #pragma once
 
 #include <Arduino.h>
-#include <vector>
-#include <DallasTemperature.h>
-#include <OneWire.h>
 #include "ForwardDeclarations.h"
 #include "Config.h"
 #include "SystemTypes.h"
 #include "Logger.h"
-#include "Config.h"
+#include "SharedDefinitions.h"
+#include "RomIndex.h"
+#include "SensorTable.h"
+#include "BusTiming.h"
+#include "OneWireBus.h"
+#include "KnownDeviceCache.h"
 
 class OneWireManager {
 public:
-    explicit OneWireManager(uint8_t pin);
+    OneWireManager(uint8_t pin, uint8_t busIndex);
+    OneWireManager(OneWireBus& bus, uint8_t busIndex);
     
     void startTemperatureConversion();
     bool checkAndCollectTemperatures();
     bool scanDevices();
-    void updateSensorList(const std::vector<TemperatureSensor>& newList);
     
-    float getCachedTemperature(const uint8_t* address);
+    // Incremental discovery: walk the bus one ROM per step between conversions
+    // and only ask for a full scan when the devices present differ from the list
+    void startDiscoveryPass();
+    bool discoveryStep();
+    bool isDiscoveryPassActive() const { return discoveryActive; }
+    bool isFullScanPending() const { return fullScanPending; }
+    void reloadSensorConfig();
+    
+    // Take the device list from the last run without searching the bus, and
+    // export the current one for the next boot (names are left empty)
+    bool loadKnownDevices(const KnownDeviceCache& cache);
+    void exportKnownDevices(KnownDeviceCache& cache) const;
+    
     String addressToString(const uint8_t* address) const;
-    const std::vector<TemperatureSensor>& getSensorList() const;
+    const SensorTable& getSensorTable() const;  // Owning task only
     
-    bool shouldScan() const;
     bool shouldRead() const;
     bool isConversionInProgress() const;
+    bool isConversionComplete();
+    uint32_t msUntilConversionCheck() const;
     bool isBusBusy() const;
     
+    // Worst-case DS18B20 conversion time for a resolution of 9..12 bits
+    static uint32_t conversionTimeMs(uint8_t resolution);
+    
+    // Bus accounting for the most recent collection pass
+    const CycleStats& getLastCycleStats() const { return lastCycleStats; }
+    
+    // Cumulative transaction latencies since boot
+    const BusTiming& getTiming() const { return timing; }
+    
 private:
-    OneWire oneWire;
-    DallasTemperature sensors;
-    std::vector<TemperatureSensor> sensorList;
+    // DS18x20 scratchpad layout and function commands
+    static constexpr uint8_t SCRATCHPAD_SIZE = 9;
+    static constexpr uint8_t SP_TEMP_LSB = 0;
+    static constexpr uint8_t SP_TEMP_MSB = 1;
+    static constexpr uint8_t SP_CONFIG = 4;
+    static constexpr uint8_t SP_COUNT_REMAIN = 6;
+    static constexpr uint8_t SP_COUNT_PER_C = 7;
+    static constexpr uint8_t SP_CRC = 8;
+    static constexpr uint8_t SP_TH = 2;
+    static constexpr uint8_t SP_TL = 3;
+    static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+    static constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+    static constexpr uint8_t CMD_COPY_SCRATCHPAD = 0x48;
+    static constexpr uint32_t EEPROM_WRITE_MS = 10;
+    static constexpr uint8_t CMD_CONVERT_T = 0x44;
+    static constexpr uint8_t CMD_READ_POWER_SUPPLY = 0xB4;
+    static constexpr int16_t RAW_POWER_ON_RESET = 0x0550;  // 85.0 C in 1/16 C
+    static constexpr uint32_t CONVERSION_POLL_INTERVAL = 10;  // ms between busy-bit polls
+    static constexpr uint8_t RESOLUTION_GROUPS =
+        MAX_SENSOR_RESOLUTION - MIN_SENSOR_RESOLUTION + 1;
+    static constexpr uint8_t STAGGER_SLOTS = CONVERSION_STAGGER_GROUPS;
+    static constexpr uint8_t GROUP_COUNT = RESOLUTION_GROUPS * STAGGER_SLOTS;
+    
+    enum class ReadStatus : uint8_t {
+        OK,
+        NO_PRESENCE,      // Nobody answered the reset pulse
+        NOT_RESPONDING,   // Bus stayed high - device gone
+        CRC_ERROR,
+        POWER_ON_RESET,   // Device reports 85.0 C without a conversion
+        SKIPPED           // Group not due this pass
+    };
+    
+    struct ReadResult {
+        int16_t raw;        // Temperature in 1/16 C
+        ReadStatus status;
+        bool armed;         // Device holds the alarm band th/tl around raw
+        int8_t th;
+        int8_t tl;
+    };
+    
+    // Sensors sharing a resolution and stagger slot are converted and read
+    // together, so coarse sensors can be sampled again while a finer conversion
+    // is still running. Group g holds resolution index g / STAGGER_SLOTS.
+    struct ConversionGroup {
+        uint8_t members;        // Sensors configured at this resolution and slot
+        uint32_t startTime;     // Start of the running conversion
+        uint32_t scheduledStart;
+        bool inProgress;
+        bool scheduled;         // Waiting for its stagger offset
+        bool due;               // Finished, waiting to be read
+    };
+    
+
+    OneWireBus& oneWire;
+    SensorTable table;
+    SensorTable scanTable;                       // Built by scanDevices()
+    RomIndex<MAX_ONEWIRE_SENSORS> sensorIndex;   // ROM -> table position
     bool busyFlag;
     mutable SemaphoreHandle_t sensorMutex;
     
@@ -40,7 +118,58 @@ private:
     uint32_t conversionStartTime;
     bool conversionInProgress;
     
+    // Conversion tracking
+    uint8_t busIndex;
+    ConversionGroup groups[GROUP_COUNT];
+    bool parasitePower;
+    bool conversionPollable;   // Single group, bus untouched since CONVERT T
+    
+    // Incremental discovery state
+    bool discoveryActive;
+    bool fullScanPending;
+    uint8_t discoverySeen;           // Known sensors found in the current pass
+    uint32_t discoverySeenMask;      // Bit per table index
+    static_assert(MAX_ONEWIRE_SENSORS <= 32, "discoverySeenMask holds one bit per sensor");
+    
+    // Preallocated buffers for the batched collection pass
+    uint8_t scratchpad[SCRATCHPAD_SIZE];
+    ReadResult readResults[MAX_ONEWIRE_SENSORS];
+    CycleStats lastCycleStats;
+    BusTiming timing;
+    
+    // Start of a timed bus transaction
+    struct Transaction {
+        uint32_t startUs;
+    };
+    
     bool verifyMutex() const;
     void setBusBusy(bool busy);
-    bool processFoundDevices(uint8_t deviceCount, std::vector<TemperatureSensor>& tempList);
+    bool searchDevices(SensorTable& found);
+    void updateSensorTable(SensorTable& found);
+    bool readPowerSupply();
+    Transaction beginTransaction() const;
+    void endTransaction(BusOperation op, const Transaction& transaction);
+    static uint32_t taskRunTime();
+    bool timedReset();
+    bool timedSearch(uint8_t* rom, bool alarmOnly = false);
+    bool alarmSearch(uint32_t& alarmMask);
+    static void alarmBand(int16_t raw, int8_t& th, int8_t& tl);
+    bool writeAlarmBand(const uint8_t* address, int8_t th, int8_t tl, uint8_t resolution);
+    int findSensorIndex(const uint8_t* address) const;
+    void rebuildSensorIndex();
+    static bool isSupportedDevice(const uint8_t* rom);
+    static OneWireBus& createBus(uint8_t pin);
+    ReadStatus readScratchpad(const uint8_t* address, int16_t& raw, CycleStats& stats);
+    uint8_t applyResolution(const uint8_t* address, uint8_t bits);
+    void rebuildGroups();
+    void markDueGroups(uint32_t now);
+    void restartGroup(uint8_t group, uint32_t now);
+    void startScheduledGroups(uint32_t now);
+    uint8_t activeGroupCount() const;
+    bool hasScheduledGroups() const;
+    uint32_t groupConversionTime(uint8_t group) const;
+    uint8_t sensorGroup(uint8_t index) const;
+    static uint8_t groupIndex(uint8_t resolution);
+    static int16_t scratchpadToRaw(const uint8_t* address, const uint8_t* data);
+    static uint8_t crc8Update(uint8_t crc, uint8_t data);
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "OneWireManager.h"
 #include "SystemTypes.h"
 #include "Config.h"
+#include "TimerWheel.h"
 #include <queue>
 
 class OneWireTask {
@@ -10,23 +11,33 @@ public:
     static void init();
     static void start();
     
-    // Public interface for task communication
+    // Public interface for task communication; commands go to every bus
     static void sendCommand(const TaskMessage& msg);
-    static OneWireManager& getManager() { return manager; }
+    static void sendCommand(uint8_t bus, const TaskMessage& msg);
+    
+    // Owned by each bus task; read elsewhere only for statistics
+    static const TimerWheel& getTimers(uint8_t bus) { return timers[bus]; }
 
 private:
     static void taskFunction(void* parameter);
-    static void processCommand(const TaskMessage& msg);
+    static void processCommand(uint8_t bus, const TaskMessage& msg);
+    static void publishSensors(uint8_t bus, const KnownDeviceCache* known = nullptr);
+    static bool restoreKnownDevices(uint8_t bus);
+    static void saveKnownDevices(uint8_t bus);
     
-    // Static members
-    static OneWireManager manager;
-    static QueueHandle_t commandQueue;
+    // One manager, queue and task per bus
+    static OneWireManager* managers[ONE_WIRE_BUS_COUNT];
+    static QueueHandle_t commandQueues[ONE_WIRE_BUS_COUNT];
     static SemaphoreHandle_t dataMutex;
+    static bool configReloadPending[ONE_WIRE_BUS_COUNT];
+    static KnownDeviceCache knownDevices[ONE_WIRE_BUS_COUNT];
+    static TimerWheel timers[ONE_WIRE_BUS_COUNT];
     
     // Constants
-    static constexpr uint32_t TASK_INTERVAL = 100;    // Base task interval in ms
+    static constexpr uint32_t TASK_INTERVAL = 100;    // Poll interval while work is pending
+    static constexpr uint32_t IDLE_WAIT = 5000;       // Longest sleep with no timer armed
     static constexpr uint32_t READ_INTERVAL = 1000;   // Temperature read interval
-    static constexpr uint32_t SCAN_INTERVAL = 30000;  // Device scan interval
+    static constexpr uint32_t DISCOVERY_INTERVAL = 5000;  // Presence check interval
     
     // Delete copy constructor and assignment operator
     OneWireTask(const OneWireTask&) = delete;
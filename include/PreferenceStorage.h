@@ -11,5 +11,7 @@ public:
     virtual bool putUInt(const char* key, uint32_t value) = 0;
     virtual uint32_t getUInt(const char* key, uint32_t defaultValue) = 0;
     virtual bool remove(const char* key) = 0;  // Add this line
+    virtual size_t putBytes(const char* key, const void* value, size_t len) = 0;
+    virtual size_t getBytes(const char* key, void* buffer, size_t maxLen) = 0;
     virtual ~PreferenceStorage() = default;
 };
\ No newline at end of file
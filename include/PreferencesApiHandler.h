@@ -2,24 +2,17 @@
 #pragma once
 
 #include <ArduinoJson.h>
-#include "OneWireManager.h"
+#include "SensorRegistry.h"
+#include "PreferencesTransaction.h"
 #include "Logger.h"
 #include "SharedDefinitions.h"
 
-// Forward declaration to avoid circular dependency
-class OneWireManager;
-
 class PreferencesApiHandler {
 public:
-    PreferencesApiHandler(OneWireManager& owManager) 
-        : oneWireManager(owManager) {}
-        
     String handleGet();
     bool handlePost(const String& jsonData);
 
 private:
-    OneWireManager& oneWireManager;
-    
     bool validateMqttConfig(JsonObject& mqtt);
     bool validateScanningConfig(JsonObject& scanning);
     bool validateDisplayConfig(JsonObject& display);
@@ -31,9 +24,11 @@ private:
     void addDisplayConfigToJson(JsonObject& root);
     void addSensorNamesToJson(JsonObject& root);
 
-    bool updateMqttConfig(JsonObject& mqtt);
-    bool updateScanningConfig(JsonObject& scanning);
-    bool updateDisplayConfig(JsonObject& display);
-    bool updateSensorNames(JsonVariant sensors);
-    bool updateRelayNames(JsonArray& relays);
+    bool updateMqttConfig(PreferencesTransaction& transaction, JsonObject& mqtt);
+    bool updateScanningConfig(PreferencesTransaction& transaction, JsonObject& scanning);
+    bool updateDisplayConfig(PreferencesTransaction& transaction, JsonObject& display);
+    bool updateSensorNames(PreferencesTransaction& transaction, JsonVariant sensors);
+    bool updateSensorResolutions(PreferencesTransaction& transaction, JsonVariant resolutions);
+    bool updateSensorFilters(PreferencesTransaction& transaction, JsonVariant filters);
+    bool updateRelayNames(PreferencesTransaction& transaction, JsonArray& relays);
 };
\ No newline at end of file
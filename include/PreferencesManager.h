@@ -4,16 +4,33 @@
 #include <Arduino.h>
 #include "SharedDefinitions.h"
 #include "PreferenceStorage.h"
+#include "SensorFilter.h"
+#include "KnownDeviceCache.h"
+#include "ConfigCache.h"
+#include "PreferencesTransaction.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "Logger.h"
 
+// Settings in NVS. Everything except credentials and the known-device blobs
+// is served from a RAM cache without locking; per-sensor settings are a single
+// blob, see SensorMetadataTable. Changes go to the cache at once and are
+// written to flash by a background task shortly afterwards.
 class PreferencesManager {
 public:
+    // address is the sensor for SENSOR_* keys and the new display sensor for
+    // DISPLAY_SENSOR, null otherwise. Called on the task that made the change.
+    using ChangeListener = void (*)(ConfigKey key, const uint8_t* address);
+    
     // Core functionality
     static void init();
+    static void setStorage(PreferenceStorage* storage);
     static void reset();
     static void printCurrentPreferences();
+    static bool flush();
+    static bool commit(PreferencesTransaction& transaction);
+    static bool subscribe(ChangeListener listener);
     
     // Credentials Management
     static bool setCredential(const char* key, const char* value);
@@ -38,6 +55,13 @@ public:
     // Sensor Management
     static bool setSensorName(const uint8_t* address, const char* name);
     static String getSensorName(const uint8_t* address);
+    static bool setSensorResolution(const uint8_t* address, uint8_t bits);
+    static uint8_t getSensorResolution(const uint8_t* address);
+    static bool setSensorFilter(const uint8_t* address, FilterType type);
+    static FilterType getSensorFilter(const uint8_t* address);
+    static void sensorFound(const uint8_t* address);  // Takes over its pre-table keys
+    static bool setKnownDevices(uint8_t bus, const KnownDeviceCache& cache);
+    static bool getKnownDevices(uint8_t bus, KnownDeviceCache& cache);
     static bool setDisplaySensor(const uint8_t* address);
     static void getDisplaySensor(uint8_t* address);
     static bool setRelayName(uint8_t relayId, const char* name);
@@ -50,13 +74,48 @@ public:
 private:
     static PreferenceStorage* prefs;
     static SemaphoreHandle_t prefsMutex;
+    static ConfigCache cache;
+    static TaskHandle_t flushTaskHandle;
+    
+    static constexpr uint8_t MAX_LISTENERS = 4;
+    static ChangeListener listeners[MAX_LISTENERS];
+    static uint8_t listenerCount;
+    
+    // Sensors whose pre-table keys are in the table but not yet removed
+    static uint8_t legacyRoms[SensorMetadataTable::CAPACITY][8];
+    static uint8_t legacyCount;
+    
+    static constexpr const char* SENSOR_METADATA_KEY = "sensor_meta";
+    static constexpr uint32_t LEGACY_KEY_MISSING = UINT32_MAX;
+    static constexpr uint32_t FLUSH_DELAY = 2000;         // Coalesce bursts of changes
+    static constexpr uint32_t FLUSH_RETRY_DELAY = 10000;
+    static constexpr uint32_t PREFS_FLUSH_TASK_STACK_SIZE = 4096;
+    static constexpr UBaseType_t PREFS_FLUSH_TASK_PRIORITY = 1;
+    
+    static PreferenceStorage* createStorage();
+    
+    // Cache management
+    static void loadCache();
+    static bool readLegacySensorKeys(const uint8_t* address, SensorMetadataTable::Entry& entry);
+    static void removeLegacySensorKeys();
+    static int loadSensor(const uint8_t* address, SensorMetadataTable::Entry& entry, bool& legacy);
+    static int storeSensor(int index, const SensorMetadataTable::Entry& entry, bool legacy, 
+                           uint32_t dirty);
+    template <typename Fn>
+    static bool updateSensor(const uint8_t* address, ConfigKey key, Fn&& fn);
+    template <typename Fn>
+    static void readSensor(const uint8_t* address, Fn&& fn);
+    static void changed(ConfigKey key, const uint8_t* address = nullptr);
+    static void notifyListeners(ConfigKey key, const uint8_t* address);
+    static void scheduleFlush();
+    static void flushTask(void* parameter);
     
     // Mutex management
     static bool acquireMutex(const char* caller);
     static void releaseMutex();
     
     // Helper methods
-    static String getSensorKey(const uint8_t* address);
+    static String getSensorKey(const uint8_t* address, const char* prefix = "s_");  // Pre-table key
     static bool isInitialized();
     
     // Prevent instantiation
@@ -0,0 +1,70 @@
+// include/PreferencesTransaction.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "ConfigCache.h"
+#include "SensorFilter.h"
+#include "SharedDefinitions.h"
+
+// A batch of preference changes. Each stage call validates its input and the
+// transaction remembers any failure; PreferencesManager::commit() applies
+// nothing unless every change was valid, skips values that are already
+// stored and writes the rest to flash in a single flush.
+class PreferencesTransaction {
+public:
+    static constexpr size_t MAX_SENSOR_CHANGES = SensorMetadataTable::CAPACITY;
+
+    bool setMqttConfig(const char* server, uint16_t port, 
+                       const char* username, const char* password);
+    bool setAutoScanEnabled(bool enabled);
+    bool setScanInterval(uint32_t seconds);
+    bool setDisplaySensor(const uint8_t* address);
+    bool setRelayName(uint8_t relayId, const char* name);
+    bool setSensorName(const uint8_t* address, const char* name);
+    bool setSensorResolution(const uint8_t* address, uint8_t bits);
+    bool setSensorFilter(const uint8_t* address, FilterType type);
+
+    // Mark the transaction invalid for input the caller checked itself
+    bool reject(const char* reason);
+
+    bool isValid() const { return valid; }
+    bool isEmpty() const { return staged == 0 && sensorCount == 0; }
+
+    // Shorthand for PreferencesManager::commit(*this)
+    bool commit();
+
+    // After a successful commit: whether any value of key actually changed
+    bool changed(ConfigKey key) const { return (applied & ConfigCache::dirtyBit(key)) != 0; }
+
+private:
+    friend class PreferencesManager;
+
+    // Fields of SensorChange::fields use ConfigCache::dirtyBit of the SENSOR_* keys
+    struct SensorChange {
+        uint8_t address[8];
+        uint8_t fields;
+        char name[MAX_SENSOR_NAME_LENGTH];
+        uint8_t resolution;
+        uint8_t filter;
+    };
+
+    SensorChange* sensorChange(const uint8_t* address);
+
+    bool valid = true;
+    uint32_t staged = 0;                // ConfigCache::dirtyBit of each global key
+    uint32_t applied = 0;               // ConfigCache::dirtyBit of each key commit changed
+
+    char mqttServer[MAX_MQTT_SERVER_LENGTH];
+    uint16_t mqttPort;
+    char mqttUsername[MAX_MQTT_CRED_LENGTH];
+    char mqttPassword[MAX_MQTT_CRED_LENGTH];
+    bool autoScan;
+    uint32_t scanInterval;
+    uint8_t displaySensor[8];
+    char relayNames[ConfigCache::RELAY_COUNT][MAX_SENSOR_NAME_LENGTH];
+    uint8_t relayMask = 0;
+
+    SensorChange sensors[MAX_SENSOR_CHANGES];
+    uint8_t sensorCount = 0;
+};
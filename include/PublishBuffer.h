@@ -0,0 +1,52 @@
+// include/PublishBuffer.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "SystemTypes.h"
+
+// Pending MQTT publications. State messages are coalesced by key so only the
+// newest value per relay is kept, however long the broker is away; events
+// that must all be delivered go through a bounded FIFO. Coalesced state is
+// handed out before events so current data reaches the broker first.
+class PublishBuffer {
+public:
+    static constexpr size_t MAX_KEYS = 4;
+    static constexpr size_t EVENT_CAPACITY = 8;
+
+    struct Counters {
+        uint32_t posted;        // Messages accepted
+        uint32_t coalesced;     // Values replaced before they were sent
+        uint32_t dropped;       // Events rejected with the FIFO full
+        uint32_t depth;         // Messages waiting now
+        uint32_t maxDepth;
+    };
+
+    bool init();
+
+    // Replace any pending value for key
+    bool post(uint8_t key, const TaskMessage& msg);
+    // Append to the event FIFO; fails when it is full
+    bool pushEvent(const TaskMessage& msg);
+    // Next message to publish, latest values first
+    bool take(TaskMessage& msg);
+
+    Counters getCounters();
+
+private:
+    uint32_t depthLocked() const { return pendingCount + eventCount; }
+    void trackDepthLocked();
+
+    TaskMessage latest[MAX_KEYS];
+    bool pending[MAX_KEYS] = {};
+    uint8_t pendingCount = 0;
+
+    TaskMessage events[EVENT_CAPACITY];
+    uint8_t eventHead = 0;
+    uint8_t eventCount = 0;
+
+    Counters counters = {};
+    SemaphoreHandle_t mutex = nullptr;
+};
@@ -0,0 +1,104 @@
+// include/RomIndex.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-capacity open-addressed map from a 64-bit OneWire ROM to a small slot
+// number. Linear probing with backward-shift deletion, so there are no
+// tombstones and lookups stay short however often sensors come and go.
+template <size_t Capacity>
+class RomIndex {
+public:
+    static constexpr int NOT_FOUND = -1;
+    
+    RomIndex() { clear(); }
+    
+    // ROM bytes in bus order (family code first) as a little-endian key
+    static uint64_t toKey(const uint8_t* rom) {
+        uint64_t key = 0;
+        for (int i = 7; i >= 0; i--) {
+            key = (key << 8) | rom[i];
+        }
+        return key;
+    }
+    
+    void clear() {
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            slots[i] = EMPTY;
+        }
+        count = 0;
+    }
+    
+    int find(uint64_t key) const {
+        for (size_t i = home(key), probes = 0; probes < TABLE_SIZE; 
+             i = (i + 1) & MASK, probes++) {
+            if (slots[i] == EMPTY) return NOT_FOUND;
+            if (keys[i] == key) return slots[i];
+        }
+        return NOT_FOUND;
+    }
+    
+    bool insert(uint64_t key, uint8_t slot) {
+        size_t i = home(key);
+        while (slots[i] != EMPTY) {
+            if (keys[i] == key) {
+                slots[i] = slot;
+                return true;
+            }
+            i = (i + 1) & MASK;
+        }
+        if (count >= Capacity) return false;
+        
+        keys[i] = key;
+        slots[i] = slot;
+        count++;
+        return true;
+    }
+    
+    void erase(uint64_t key) {
+        size_t i = home(key);
+        while (slots[i] != EMPTY && keys[i] != key) {
+            i = (i + 1) & MASK;
+        }
+        if (slots[i] == EMPTY) return;
+        
+        // Pull following entries of the cluster back so no probe chain breaks
+        size_t hole = i;
+        for (size_t j = (hole + 1) & MASK; slots[j] != EMPTY; j = (j + 1) & MASK) {
+            size_t h = home(keys[j]);
+            bool movable = (hole <= j) ? (h <= hole || h > j) : (h <= hole && h > j);
+            if (movable) {
+                keys[hole] = keys[j];
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole] = EMPTY;
+        count--;
+    }
+    
+    size_t size() const { return count; }
+
+private:
+    // Power of two, at most half full
+    static constexpr size_t tableSizeFor(size_t n) {
+        size_t size = 1;
+        while (size < n * 2) size <<= 1;
+        return size;
+    }
+    static constexpr size_t TABLE_SIZE = tableSizeFor(Capacity);
+    static constexpr size_t MASK = TABLE_SIZE - 1;
+    static constexpr uint8_t EMPTY = 0xFF;
+    static_assert(Capacity < EMPTY, "slot numbers must fit below the empty marker");
+    
+    // The serial number bytes are already well mixed; fold the key and spread it
+    static size_t home(uint64_t key) {
+        uint32_t folded = static_cast<uint32_t>(key ^ (key >> 32));
+        return (folded * 2654435761u >> 16) & MASK;
+    }
+    
+    uint64_t keys[TABLE_SIZE];
+    uint8_t slots[TABLE_SIZE];
+    size_t count;
+};
@@ -0,0 +1,60 @@
+// include/SensorFilter.h
+#pragma once
+
+#include <cstdint>
+
+enum class FilterType : uint8_t {
+    NONE,       // Pass samples through
+    MEDIAN,     // Rolling median over MEDIAN_WINDOW samples
+    EMA,        // Exponential moving average, alpha = 1 / 2^EMA_SHIFT
+    KALMAN,     // 1-D constant-level Kalman with innovation gate
+    COUNT
+};
+
+// Streaming filter for one sensor. Works on 1/16 C fixed point, keeps a fixed
+// amount of state and costs constant time per sample.
+class SensorFilter {
+public:
+    static constexpr uint8_t MEDIAN_WINDOW = 5;
+    static constexpr uint8_t EMA_SHIFT = 2;
+
+    // Switch to a filter type; history is only dropped when the type changes
+    void configure(FilterType newType);
+    void reset();
+    int16_t update(int16_t sample);
+
+    FilterType getType() const { return type; }
+
+    static const char* typeName(FilterType type);
+    static bool parseType(const char* name, FilterType& out);
+
+private:
+    // Kalman tuning in (1/16 C)^2: DS18B20 noise is about one LSB at 12 bit
+    static constexpr float KALMAN_PROCESS_NOISE = 0.25f;
+    static constexpr float KALMAN_MEASUREMENT_NOISE = 4.0f;
+    static constexpr float KALMAN_GATE_SIGMA = 4.0f;
+    static constexpr float KALMAN_MIN_GATE = 16.0f;      // Never reject steps below 1 C
+    static constexpr uint8_t KALMAN_MAX_REJECTS = 3;     // Then accept it as a real step
+
+    int16_t updateMedian(int16_t sample);
+    int16_t updateEma(int16_t sample);
+    int16_t updateKalman(int16_t sample);
+
+    FilterType type = FilterType::NONE;
+    uint8_t samples = 0;
+
+    union {
+        struct {
+            int16_t window[MEDIAN_WINDOW];
+            uint8_t head;
+        } median;
+        struct {
+            int32_t acc;        // Average in 1/256 C
+        } ema;
+        struct {
+            float estimate;
+            float variance;
+            uint8_t rejects;
+        } kalman;
+    } state = {};
+};
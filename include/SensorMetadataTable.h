@@ -0,0 +1,120 @@
+// include/SensorMetadataTable.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Config.h"
+#include "RomIndex.h"
+#include "SensorFilter.h"
+#include "SharedDefinitions.h"
+
+// Settings of every configured sensor, keyed by full ROM and stored as one
+// NVS blob, so they load with a single read. Only count entries are stored,
+// and the ROM index is rebuilt in RAM after loading. Sensors without an entry
+// use the defaults.
+struct SensorMetadataTable {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t CAPACITY = MAX_TOTAL_SENSORS * 2;
+    static constexpr int NOT_FOUND = -1;
+
+    struct Entry {
+        uint8_t rom[8];
+        char name[MAX_SENSOR_NAME_LENGTH];
+        uint8_t resolution;
+        uint8_t filter;                         // FilterType
+
+        void setDefaults(const uint8_t* address) {
+            memcpy(rom, address, 8);
+            name[0] = '\0';
+            resolution = DEFAULT_SENSOR_RESOLUTION;
+            filter = static_cast<uint8_t>(FilterType::NONE);
+        }
+
+        bool sameSettings(const Entry& other) const {
+            return strncmp(name, other.name, MAX_SENSOR_NAME_LENGTH) == 0 &&
+                   resolution == other.resolution && filter == other.filter;
+        }
+
+        bool isDefault() const {
+            return name[0] == '\0' && resolution == DEFAULT_SENSOR_RESOLUTION &&
+                   filter == static_cast<uint8_t>(FilterType::NONE);
+        }
+    };
+
+    uint8_t version;
+    uint8_t count;
+    Entry entries[CAPACITY];
+    RomIndex<CAPACITY> index;                   // Not stored
+
+    static constexpr size_t HEADER_SIZE = 2;
+
+    void clear() {
+        version = VERSION;
+        count = 0;
+        index.clear();
+    }
+
+    size_t size() const {
+        return HEADER_SIZE + count * sizeof(Entry);
+    }
+
+    // Blob of len bytes read back from storage; out-of-range values are reset
+    bool isValid(size_t len) {
+        if (len < HEADER_SIZE || version != VERSION || count > CAPACITY || len != size()) {
+            return false;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            Entry& entry = entries[i];
+            entry.name[MAX_SENSOR_NAME_LENGTH - 1] = '\0';
+            if (entry.resolution < MIN_SENSOR_RESOLUTION || entry.resolution > MAX_SENSOR_RESOLUTION) {
+                entry.resolution = DEFAULT_SENSOR_RESOLUTION;
+            }
+            if (entry.filter >= static_cast<uint8_t>(FilterType::COUNT)) {
+                entry.filter = static_cast<uint8_t>(FilterType::NONE);
+            }
+        }
+        index.clear();
+        for (uint8_t i = 0; i < count; i++) {
+            index.insert(RomIndex<CAPACITY>::toKey(entries[i].rom), i);
+        }
+        return true;
+    }
+
+    int find(const uint8_t* rom) const {
+        int i = index.find(RomIndex<CAPACITY>::toKey(rom));
+        return (i >= 0 && i < count) ? i : NOT_FOUND;
+    }
+
+    // Entries add() can still hand out
+    size_t room() const {
+        size_t free = CAPACITY - count;
+        for (uint8_t i = 0; i < count; i++) {
+            if (entries[i].isDefault()) free++;
+        }
+        return free;
+    }
+
+    // Entry for a new sensor with default settings. Entries are only added
+    // for sensors with settings of their own, so one whose settings are all
+    // back to the defaults is free, and is reused once the table is full.
+    int add(const uint8_t* rom) {
+        int slot = NOT_FOUND;
+        if (count < CAPACITY) {
+            slot = count++;
+        } else {
+            for (uint8_t i = 0; i < count && slot == NOT_FOUND; i++) {
+                if (entries[i].isDefault()) slot = i;
+            }
+            if (slot == NOT_FOUND) return slot;
+            index.erase(RomIndex<CAPACITY>::toKey(entries[slot].rom));
+        }
+        entries[slot].setDefaults(rom);
+        index.insert(RomIndex<CAPACITY>::toKey(rom), slot);
+        return slot;
+    }
+};
+
+static_assert(offsetof(SensorMetadataTable, entries) == SensorMetadataTable::HEADER_SIZE,
+              "Table entries follow the header directly");
+static_assert(SensorMetadataTable::CAPACITY <= UINT8_MAX, "count is a uint8_t");
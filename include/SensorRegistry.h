@@ -0,0 +1,94 @@
+// include/SensorRegistry.h
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "Config.h"
+#include "SharedDefinitions.h"
+#include "SystemTypes.h"
+#include "RomIndex.h"
+#include "SensorTable.h"
+#include "KnownDeviceCache.h"
+#include "ConfigCache.h"
+
+// Merged view of the sensors on all OneWire buses. Each OneWire task publishes
+// its own bus after every scan and collection pass; every other task reads
+// from here instead of touching a bus manager.
+//
+// Sensors live in fixed slots. A sensor keeps its slot for as long as it stays
+// on the bus, and lookups by ROM go through a hash index instead of a scan.
+//
+// Writers build the next snapshot in a back buffer and publish it by bumping
+// the generation. Readers copy from the published buffer without taking a
+// lock and retry only if a writer got round to reusing that buffer meanwhile.
+class SensorRegistry {
+public:
+    static constexpr int NO_SLOT = RomIndex<MAX_TOTAL_SENSORS>::NOT_FOUND;
+    
+    static void init();
+    
+    // Called by the task that owns the bus
+    static void update(uint8_t bus, const SensorTable& table, 
+                       const KnownDeviceCache* known = nullptr);
+    
+    // Lock-free readers
+    static std::vector<TemperatureSensor> getSensors();
+    static bool findSensor(const uint8_t* address, TemperatureSensor& sensor);
+    static int findSlot(const uint8_t* address);
+    static bool getSensor(int slot, TemperatureSensor& sensor);
+    static size_t getSensorCount();
+    
+    // Names are display data and kept in a cold table next to the snapshots
+    static String getSensorName(const uint8_t* address);
+    static void setSensorName(const uint8_t* address, const char* name);
+    
+    static uint32_t getGeneration() { return generation.load(std::memory_order_acquire); }
+    
+    static uint64_t romKey(const uint8_t* address) { 
+        return RomIndex<MAX_TOTAL_SENSORS>::toKey(address); 
+    }
+
+private:
+    struct Snapshot {
+        std::atomic<uint32_t> seq;      // Odd while the buffer is being written
+        uint8_t count;
+        bool slotUsed[MAX_TOTAL_SENSORS];
+        TemperatureSensor slots[MAX_TOTAL_SENSORS];
+        RomIndex<MAX_TOTAL_SENSORS> index;
+    };
+    
+    static Snapshot buffers[2];
+    static std::atomic<uint32_t> generation;   // Published buffer is generation & 1
+    static SemaphoreHandle_t writerMutex;
+    
+    static char names[MAX_TOTAL_SENSORS][MAX_SENSOR_NAME_LENGTH];
+    static uint64_t nameKeys[MAX_TOTAL_SENSORS];
+    static SemaphoreHandle_t namesMutex;
+    
+    static int allocateSlot(const Snapshot& snapshot);
+    static void onConfigChanged(ConfigKey key, const uint8_t* address);
+    static void loadName(int slot, const uint8_t* address, const KnownDeviceCache* known);
+    
+    // Run fn on a consistent copy of the published snapshot's contents.
+    // fn must only copy out of the snapshot; it may run more than once.
+    template <typename Fn>
+    static void readSnapshot(Fn&& fn) {
+        while (true) {
+            const Snapshot& snapshot = buffers[generation.load(std::memory_order_acquire) & 1];
+            uint32_t before = snapshot.seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                fn(snapshot);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (snapshot.seq.load(std::memory_order_relaxed) == before) return;
+            }
+            taskYIELD();
+        }
+    }
+    
+    // Prevent instantiation
+    SensorRegistry() = delete;
+};
@@ -0,0 +1,94 @@
+// include/SensorTable.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Config.h"
+#include "SystemTypes.h"
+#include "SensorFilter.h"
+
+// Sensor state of one bus as parallel arrays in static storage. The collection
+// pass only walks addresses, raw readings and error counters, so those stay
+// dense; names live in SensorRegistry's cold table.
+struct SensorTable {
+    static constexpr uint8_t FLAG_VALID = 0x01;
+    static constexpr uint8_t FLAG_ACTIVE = 0x02;
+    static constexpr uint8_t FLAG_ALARM_ARMED = 0x04;   // TH/TL set around current value
+    static constexpr int16_t RAW_DISCONNECTED = FixedPoint::RAW_DISCONNECTED;
+    
+    uint8_t count;
+    uint8_t address[MAX_ONEWIRE_SENSORS][8];
+    int16_t raw[MAX_ONEWIRE_SENSORS];            // Current filtered reading, 1/16 C
+    int16_t sample[MAX_ONEWIRE_SENSORS];         // Last unfiltered sample, 1/16 C
+    int16_t lastValidRaw[MAX_ONEWIRE_SENSORS];   // Last good reading, 1/16 C
+    uint32_t lastReadTime[MAX_ONEWIRE_SENSORS];
+    uint8_t consecutiveErrors[MAX_ONEWIRE_SENSORS];
+    uint8_t resolution[MAX_ONEWIRE_SENSORS];
+    uint8_t flags[MAX_ONEWIRE_SENSORS];
+    int8_t alarmTh[MAX_ONEWIRE_SENSORS];         // Band last written, while FLAG_ALARM_ARMED
+    int8_t alarmTl[MAX_ONEWIRE_SENSORS];
+    uint32_t readCount[MAX_ONEWIRE_SENSORS];     // Scratchpad reads since discovery
+    uint32_t errorCount[MAX_ONEWIRE_SENSORS];    // Reads that failed
+    SensorFilter filter[MAX_ONEWIRE_SENSORS];
+    
+    void clear() { count = 0; }
+    bool isValid(size_t i) const { return flags[i] & FLAG_VALID; }
+    
+    // Append a newly discovered sensor, returns its index or -1 when full
+    int add(const uint8_t* rom, uint8_t bits, FilterType filterType = FilterType::NONE) {
+        if (count >= MAX_ONEWIRE_SENSORS) return -1;
+        
+        uint8_t i = count++;
+        memcpy(address[i], rom, 8);
+        raw[i] = RAW_DISCONNECTED;
+        sample[i] = RAW_DISCONNECTED;
+        lastValidRaw[i] = RAW_DISCONNECTED;
+        lastReadTime[i] = 0;
+        consecutiveErrors[i] = 0;
+        resolution[i] = bits;
+        flags[i] = FLAG_ACTIVE;
+        readCount[i] = 0;
+        errorCount[i] = 0;
+        filter[i] = SensorFilter();
+        filter[i].configure(filterType);
+        return i;
+    }
+    
+    // Carry the reading history of entry src in other over to entry i. Filter
+    // history only carries over while the filter type stays the same.
+    void copyState(size_t i, const SensorTable& other, size_t src) {
+        raw[i] = other.raw[src];
+        sample[i] = other.sample[src];
+        lastValidRaw[i] = other.lastValidRaw[src];
+        lastReadTime[i] = other.lastReadTime[src];
+        consecutiveErrors[i] = other.consecutiveErrors[src];
+        flags[i] = other.flags[src];
+        alarmTh[i] = other.alarmTh[src];
+        alarmTl[i] = other.alarmTl[src];
+        if (other.filter[src].getType() == filter[i].getType()) {
+            filter[i] = other.filter[src];
+        }
+    }
+    
+    void copyCounters(size_t i, const SensorTable& other, size_t src) {
+        readCount[i] = other.readCount[src];
+        errorCount[i] = other.errorCount[src];
+    }
+    
+    void toSensor(size_t i, uint8_t bus, TemperatureSensor& out) const {
+        memcpy(out.address, address[i], 8);
+        out.temperatureRaw = raw[i];
+        out.sampleRaw = sample[i];
+        out.filterType = static_cast<uint8_t>(filter[i].getType());
+        out.lastValidRaw = lastValidRaw[i];
+        out.lastReadTime = lastReadTime[i];
+        out.consecutiveErrors = consecutiveErrors[i];
+        out.resolution = resolution[i];
+        out.bus = bus;
+        out.isActive = flags[i] & FLAG_ACTIVE;
+        out.valid = flags[i] & FLAG_VALID;
+        out.readCount = readCount[i];
+        out.errorCount = errorCount[i];
+    }
+};
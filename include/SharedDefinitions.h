@@ -11,6 +11,11 @@ constexpr uint32_t DEFAULT_SCAN_INTERVAL = 60;    // Default interval between sc
 constexpr uint32_t MIN_SCAN_INTERVAL = 10;        // Minimum allowed interval
 constexpr uint32_t MAX_SCAN_INTERVAL = 3600;      // Maximum allowed interval (1 hour)
 
+// DS18B20 conversion resolution (bits)
+constexpr uint8_t MIN_SENSOR_RESOLUTION = 9;      // 0.5 C, 94 ms conversion
+constexpr uint8_t MAX_SENSOR_RESOLUTION = 12;     // 0.0625 C, 750 ms conversion
+constexpr uint8_t DEFAULT_SENSOR_RESOLUTION = 12;
+
 // Storage size limits
 constexpr size_t MAX_SENSOR_NAME_LENGTH = 32;     // Maximum length for sensor names
 constexpr size_t MAX_MQTT_SERVER_LENGTH = 64;     // Maximum length for MQTT broker address
@@ -0,0 +1,116 @@
+// include/SimulatedOneWireBus.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "OneWireBus.h"
+
+// Software model of a bus of DS18B20 sensors. Implements the ROM and function
+// commands OneWireManager uses, with real conversion delays and optional CRC
+// errors, dropouts and hot-plugging. Has no Arduino or FreeRTOS dependencies,
+// so it also runs in a native host build.
+class SimulatedOneWireBus : public OneWireBus {
+public:
+    using Clock = uint32_t (*)();   // Milliseconds since an arbitrary start
+
+    struct Faults {
+        float crcErrorRate = 0.0f;  // Chance a scratchpad read has a flipped bit
+        float dropoutRate = 0.0f;   // Chance a device sits out one transaction
+    };
+
+    // Activity, with bus time estimated from standard-speed slot timings
+    struct Counters {
+        uint32_t resets;
+        uint32_t bytesWritten;
+        uint32_t bytesRead;
+        uint32_t bitsRead;
+        uint32_t searches;
+        uint32_t conversions;
+        uint32_t crcErrorsInjected;
+        uint32_t dropouts;
+        uint64_t busTimeUs;
+    };
+
+    // A null clock uses millis() on Arduino and a steady clock elsewhere
+    explicit SimulatedOneWireBus(uint32_t seed = 1, Clock clock = nullptr);
+
+    // Devices can be added, removed or unplugged at any time
+    size_t addDevice(int16_t temperatureRaw, bool parasite = false);
+    void populate(size_t count, int16_t baseRaw = 20 * 16);
+    bool removeDevice(const uint8_t* rom);
+    void setPresent(size_t index, bool present);
+    void setTemperature(size_t index, int16_t temperatureRaw);
+    size_t getDeviceCount() const { return devices.size(); }
+    const uint8_t* getDeviceRom(size_t index) const { return devices[index].rom; }
+
+    void setFaults(const Faults& newFaults) { faults = newFaults; }
+    const Counters& getCounters() const { return counters; }
+    void resetCounters() { counters = {}; }
+
+    bool reset() override;
+    void select(const uint8_t* rom) override;
+    void skip() override;
+    void write(uint8_t value, bool power) override;
+    uint8_t read() override;
+    uint8_t readBit() override;
+    void resetSearch() override;
+    bool search(uint8_t* rom, bool alarmOnly) override;
+
+private:
+    static constexpr uint8_t SCRATCHPAD_SIZE = 9;
+    static constexpr int16_t RAW_POWER_ON = 0x0550;   // 85.0 C
+
+    // Standard-speed slot timings (us)
+    static constexpr uint32_t RESET_US = 960;
+    static constexpr uint32_t SLOT_US = 65;
+
+    struct Device {
+        uint8_t rom[8];
+        int16_t temperature;    // Value the next conversion will measure
+        int16_t reading;        // Temperature register
+        uint8_t th, tl, config;
+        uint8_t eepromTh, eepromTl, eepromConfig;
+        uint32_t conversionStart;
+        uint32_t conversionTime;
+        bool converting;
+        bool alarm;
+        bool parasite;
+        bool present;
+        bool droppedOut;        // Ignoring the current transaction
+    };
+
+    enum class State : uint8_t {
+        IDLE,
+        FUNCTION,           // ROM command done, waiting for a function command
+        READ_SCRATCHPAD,
+        WRITE_SCRATCHPAD,
+        CONVERTING,
+        READ_POWER
+    };
+
+    uint32_t now() const;
+    uint32_t nextRandom();
+    bool chance(float probability);
+    void finishConversions();
+    void buildScratchpad(const Device& device, uint8_t* out) const;
+    void startConversion(Device& device);
+    uint8_t resolutionBits(const Device& device) const;
+
+    std::vector<Device> devices;
+    std::vector<size_t> selected;   // Devices addressed since the last reset
+    std::vector<size_t> searchCandidates;   // Kept so a search step does not allocate
+    State state;
+    uint8_t buffer[SCRATCHPAD_SIZE];
+    uint8_t bufferPos;
+
+    // Search state as in the 1-Wire search algorithm
+    uint8_t searchRom[8];
+    uint8_t lastDiscrepancy;
+    bool lastDevice;
+
+    Faults faults;
+    Counters counters;
+    Clock clock;
+    uint32_t rng;
+};
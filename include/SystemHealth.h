@@ -3,6 +3,9 @@
 #include <Arduino.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "Config.h"
+#include "BusTiming.h"
+#include "TimerWheel.h"
 
 class SystemHealth {
 public:
@@ -12,11 +15,17 @@ public:
     static String getStatusReport();
     static void recordWatchdogNearMiss();
     
+    // OneWire transaction timing and the last collection pass, copied in by
+    // each bus task
+    static void updateBusTiming(uint8_t bus, const BusTiming& timing, const CycleStats& cycle);
+    static String getBusStatsJson();
+    
 private:
     // Private methods
     static void updateHeapMetrics();
     static void updateStackMetrics();
     static void updateTaskMetrics();  // Add this declaration
+    static void appendTimerReport(String& report, const char* owner, const TimerWheel& timers);
     
     // Metrics structure to hold all system health data
     struct Metrics {
@@ -32,6 +41,8 @@ private:
     
     // Static members
     static Metrics metrics;
+    static BusTiming busTiming[ONE_WIRE_BUS_COUNT];
+    static CycleStats lastCycle[ONE_WIRE_BUS_COUNT];
     static SemaphoreHandle_t metricsMutex;
     static uint32_t lastUpdateTime;
 };
\ No newline at end of file
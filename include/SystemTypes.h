@@ -2,14 +2,15 @@
 #pragma once
 
 #include <cstdint>
-#include "OneWireManager.h"  // This should contain TemperatureSensor definition
+#include "Config.h"
+#include "FixedPoint.h"
 
 enum class MessageType {
     RELAY_CHANGE_REQUEST,
     SENSOR_SCAN_REQUEST,
     TEMPERATURE_READ_REQUEST,
-    SENSOR_DATA,
-    RELAY_STATE
+    RELAY_STATE,
+    SENSOR_CONFIG_CHANGED
 };
 
 struct RelayChangeRequest {
@@ -25,11 +26,16 @@ struct RelayStateData {  // Renamed to avoid confusion
 // Temperature sensor data structure
 struct TemperatureSensor {
     uint8_t address[8];                              // Sensor's unique address
-    char friendlyName[MAX_FRIENDLY_NAME_LENGTH];     // Human-readable name
-    float temperature;                               // Current temperature reading
-    float lastValidReading;                         // Last known good reading
+    int16_t temperatureRaw;                         // Current reading, 1/16 C
+    int16_t lastValidRaw;                           // Last known good reading, 1/16 C
     uint32_t lastReadTime;                          // Timestamp of last reading
+    int16_t sampleRaw;                              // Unfiltered reading in 1/16 C
+    uint8_t filterType;                             // FilterType applied to temperatureRaw
     uint8_t consecutiveErrors;                      // Error tracking
+    uint8_t resolution;                             // Conversion resolution (9-12 bit)
+    uint8_t bus;                                    // Index of the OneWire bus
+    uint32_t readCount;                             // Scratchpad reads since discovery
+    uint32_t errorCount;                            // Failed reads since discovery
     bool isActive;                                  // Whether sensor is currently responding
     bool valid;                                     // Whether current reading is valid
 };
@@ -37,7 +43,6 @@ struct TemperatureSensor {
 union MessageData {
     RelayChangeRequest relayChange;
     RelayStateData relayState;    // Updated name
-    TemperatureSensor sensorData; // Explicit name for sensor data
 };
 
 struct TaskMessage {
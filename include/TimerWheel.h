@@ -0,0 +1,72 @@
+// include/TimerWheel.h
+#pragma once
+
+#include <cstdint>
+
+// Hashed timer wheel for the periodic duties of one task. runDue() returns
+// the timers that expired as a bit mask, so the owning task does the work in
+// its own context, and msUntilNext() tells it how long it may sleep. Not
+// thread safe; only the owning task may arm or run timers.
+//
+// Each timer has a slack: it may run up to slackMs after its deadline, which
+// lets timers that fall due close together share one wakeup. Periodic timers
+// are rescheduled from their deadline rather than from when they ran, so they
+// do not drift; periods missed entirely are skipped and counted.
+class TimerWheel {
+public:
+    static constexpr uint8_t MAX_TIMERS = 16;
+    static constexpr uint8_t INVALID = 0xFF;
+    static constexpr uint32_t TICK_MS = 10;
+    static constexpr uint8_t SLOT_COUNT = 64;
+
+    struct Stats {
+        uint32_t runs;
+        uint32_t lateRuns;      // Ran later than deadline + slack
+        uint32_t skipped;       // Whole periods missed
+        uint32_t maxLateMs;     // Worst delay past the deadline
+    };
+
+    TimerWheel();
+
+    // A period of 0 makes a one-shot timer. Timers start disarmed.
+    uint8_t add(const char* name, uint32_t periodMs, uint32_t slackMs = 0);
+    void start(uint8_t id, uint32_t now, uint32_t delayMs);
+    void stop(uint8_t id);
+    bool isArmed(uint8_t id) const { return id < count && timers[id].armed; }
+
+    // Expired timers as bit(id); one-shot timers are disarmed
+    uint32_t runDue(uint32_t now);
+    // Time until the latest moment the next timer may run, at most maxWaitMs
+    uint32_t msUntilNext(uint32_t now, uint32_t maxWaitMs) const;
+
+    uint8_t getCount() const { return count; }
+    const char* getName(uint8_t id) const { return timers[id].name; }
+    const Stats& getStats(uint8_t id) const { return timers[id].stats; }
+
+    static constexpr uint32_t bit(uint8_t id) { return 1UL << id; }
+
+private:
+    static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "Slot count must be a power of two");
+    static_assert(MAX_TIMERS <= 32, "Expired timers are returned as a 32-bit mask");
+
+    struct Timer {
+        const char* name;
+        uint32_t periodMs;
+        uint32_t slackMs;
+        uint32_t deadline;
+        uint8_t next;           // Next timer in the same slot
+        bool armed;
+        Stats stats;
+    };
+
+    static uint8_t slotOf(uint32_t time) { return (time / TICK_MS) & (SLOT_COUNT - 1); }
+    void link(uint8_t id);
+    void unlink(uint8_t id);
+    void expire(uint8_t id, uint32_t now);
+
+    Timer timers[MAX_TIMERS];
+    uint8_t slots[SLOT_COUNT];  // First timer of each slot
+    uint8_t count;
+    uint32_t lastRun;
+    bool hasRun;
+};
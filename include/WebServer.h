@@ -3,7 +3,10 @@
 
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
-#include "OneWireManager.h"
+#include <atomic>
+#include <memory>
+#include "ConfigCache.h"
+#include "SensorRegistry.h"
 #include "PreferencesApiHandler.h"
 #include "Logger.h"
 #include "SharedDefinitions.h"
@@ -13,13 +16,18 @@
 
 class WebServer {
 public:
-    WebServer(OneWireManager& owManager);
+    WebServer();
     void begin();
 
 private:
     AsyncWebServer server;
-    OneWireManager& oneWireManager;
     PreferencesApiHandler preferencesHandler;
+    
+    // Cached /api/sensors body and the versions it was built from
+    std::shared_ptr<const String> sensorsBody;
+    uint32_t sensorsBodyGeneration = 0;
+    uint32_t sensorsBodyConfigVersion = 0;
+    static std::atomic<uint32_t> sensorsConfigVersion;
 
     // Setup methods
     void setupRoutes();
@@ -39,7 +47,10 @@ private:
     static String extractToken(AsyncWebServerRequest* request);
 
     // Helper methods
-    JsonObject createSensorJson(JsonArray& array, const TemperatureSensor& sensor);
+    std::shared_ptr<const String> getSensorsBody();
+    static void onConfigChanged(ConfigKey key, const uint8_t* address);
+    JsonObject createSensorJson(JsonArray& array, const TemperatureSensor& sensor,
+                                uint64_t displaySensorKey);
     void sendErrorResponse(AsyncWebServerRequest* request, int code, const String& message);
     void sendJsonResponse(AsyncWebServerRequest* request, const String& json);
     static String addressToString(const uint8_t* address);
@@ -0,0 +1,40 @@
+// native/bench/Allocations.cpp
+// native/bench/Allocations.cpp
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Bench.h"
+
+// Every allocation in the program goes through here, so a benchmark can
+// count those of the code it runs
+
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+}
+
+uint64_t Bench::allocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
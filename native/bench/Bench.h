@@ -0,0 +1,32 @@
+// native/bench/Bench.h
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+class FilePreferenceStorage;
+
+// Host benchmarks, run by name from main(). Each prints its figures and
+// returns false if a check on them failed.
+namespace Bench {
+
+bool stress();
+bool slots();
+bool heap();
+bool prefs();
+
+// PreferencesManager on a fresh file, since the code under test reads its
+// settings from there
+bool initPreferences();
+FilePreferenceStorage& preferenceStorage();
+
+// Heap allocations since start
+uint64_t allocations();
+
+// Wall-clock time, for the work between simulated waits
+inline uint64_t nowNs() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace Bench
@@ -0,0 +1,121 @@
+// native/bench/BusRig.h
+#pragma once
+
+#include <Arduino.h>
+#include "Bench.h"
+#include "OneWireManager.h"
+#include "SimulatedOneWireBus.h"
+
+// A simulated bus and its manager, driven the way OneWireTask drives a real
+// one. The bus runs on the shared clock, so waiting for conversions skips
+// ahead instead of sleeping.
+class BusRig {
+public:
+    BusRig(uint8_t index, size_t sensors, uint32_t seed)
+        : bus(populated(seed, sensors))
+        , manager(bus, index)
+        , collections(0)
+        , collectNs(0)
+        , maxCollectNs(0)
+        , collectTraffic{}
+        , collectAllocations(0) {
+        manager.scanDevices();
+    }
+    BusRig(const BusRig&) = delete;
+    BusRig& operator=(const BusRig&) = delete;
+    
+    // One pass of the task loop; true if temperatures were collected
+    bool poll() {
+        if (manager.isDiscoveryPassActive()) {
+            manager.discoveryStep();
+        }
+        if (manager.isFullScanPending() && !manager.isBusBusy() && !manager.isConversionInProgress()) {
+            manager.scanDevices();
+        }
+        if (!manager.isConversionInProgress()) {
+            manager.startTemperatureConversion();
+            return false;
+        }
+        if (!manager.isConversionComplete()) return false;
+        
+        SimulatedOneWireBus::Counters before = bus.getCounters();
+        uint64_t allocations = Bench::allocations();
+        uint64_t start = Bench::nowNs();
+        manager.checkAndCollectTemperatures();
+        uint64_t elapsed = Bench::nowNs() - start;
+        collectAllocations += Bench::allocations() - allocations;
+        addTraffic(collectTraffic, before, bus.getCounters());
+        collectNs += elapsed;
+        if (elapsed > maxCollectNs) maxCollectNs = elapsed;
+        collections++;
+        return true;
+    }
+    
+    // Until the next poll has something to do
+    uint32_t msUntilPoll() const {
+        if (manager.isDiscoveryPassActive() || manager.isFullScanPending()) return 0;
+        return manager.isConversionInProgress() ? manager.msUntilConversionCheck() : 0;
+    }
+    
+    size_t validSensors() const {
+        const SensorTable& table = manager.getSensorTable();
+        size_t valid = 0;
+        for (uint8_t i = 0; i < table.count; i++) {
+            if (table.isValid(i)) valid++;
+        }
+        return valid;
+    }
+    
+    // Read and write time slots, as OneWireManager counts them
+    static uint64_t slots(const SimulatedOneWireBus::Counters& counters) {
+        return 8ULL * (counters.bytesWritten + counters.bytesRead) + counters.bitsRead;
+    }
+    
+    static void addTraffic(SimulatedOneWireBus::Counters& sum, const SimulatedOneWireBus::Counters& before,
+                           const SimulatedOneWireBus::Counters& after) {
+        sum.resets += after.resets - before.resets;
+        sum.bytesWritten += after.bytesWritten - before.bytesWritten;
+        sum.bytesRead += after.bytesRead - before.bytesRead;
+        sum.bitsRead += after.bitsRead - before.bitsRead;
+        sum.busTimeUs += after.busTimeUs - before.busTimeUs;
+    }
+    
+    SimulatedOneWireBus bus;
+    OneWireManager manager;
+    uint32_t collections;
+    uint64_t collectNs;
+    uint64_t maxCollectNs;
+    SimulatedOneWireBus::Counters collectTraffic;   // Bus activity of the collections alone
+    uint64_t collectAllocations;
+
+private:
+    static uint32_t clock() { return (uint32_t)millis(); }
+    
+    static SimulatedOneWireBus populated(uint32_t seed, size_t sensors) {
+        SimulatedOneWireBus bus(seed, clock);
+        bus.populate(sensors);
+        return bus;
+    }
+};
+
+// Polls every rig until each has collected cycles more times, skipping the
+// clock ahead to the next due poll. False if they stall.
+template <typename Rigs, typename Fn>
+bool runCycles(Rigs& rigs, uint32_t cycles, Fn&& afterCollect) {
+    const unsigned long deadline = millis() + cycles * 10000UL;
+    while (millis() < deadline) {
+        bool done = true;
+        uint32_t wait = UINT32_MAX;
+        for (size_t i = 0; i < rigs.size(); i++) {
+            BusRig& rig = *rigs[i];
+            if (rig.collections >= cycles) continue;
+            done = false;
+            if (rig.poll()) afterCollect(i, rig);
+            wait = std::min(wait, rig.msUntilPoll());
+        }
+        if (done) return true;
+        if (wait == UINT32_MAX || wait == 0) wait = 1;
+        vTaskDelay(pdMS_TO_TICKS(wait));
+    }
+    return false;
+}
@@ -0,0 +1,139 @@
+// native/bench/HeapBench.cpp
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "Bench.h"
+#include "BusRig.h"
+
+namespace {
+constexpr uint32_t CYCLES = 50;
+constexpr uint32_t SCANS = 20;
+
+// The record sensor lists held before the struct-of-arrays table
+struct LegacySensor {
+    uint8_t address[8];
+    char friendlyName[MAX_FRIENDLY_NAME_LENGTH];
+    float temperature;
+    float lastValidReading;
+    uint32_t lastReadTime;
+    uint8_t consecutiveErrors;
+    uint8_t resolution;
+    uint8_t bus;
+    bool isActive;
+    bool valid;
+};
+
+// Container traffic of the list-based manager, replayed on the same sensors.
+// That manager drove the OneWire and DallasTemperature libraries directly, so
+// it cannot run here itself.
+class LegacyLists {
+public:
+    // Every read built a fresh list and swapped it in
+    void read(const SensorTable& table) {
+        std::vector<LegacySensor> tempList;
+        for (uint8_t i = 0; i < table.count; i++) {
+            tempList.push_back(record(table, i));
+        }
+        sensorList = std::move(tempList);
+    }
+
+    // A scan searched into one list, then merged it into a second one that
+    // kept the readings of sensors already known
+    void scan(const SensorTable& table) {
+        std::vector<LegacySensor> tempList;
+        for (uint8_t i = 0; i < table.count; i++) {
+            tempList.push_back(record(table, i));
+        }
+
+        std::vector<LegacySensor> updatedList;
+        updatedList.reserve(tempList.size());
+        for (const LegacySensor& found : tempList) {
+            LegacySensor updated = found;
+            for (const LegacySensor& existing : sensorList) {
+                if (memcmp(existing.address, found.address, 8) == 0 && existing.valid) {
+                    updated.temperature = existing.temperature;
+                    updated.lastValidReading = existing.lastValidReading;
+                    updated.lastReadTime = existing.lastReadTime;
+                    break;
+                }
+            }
+            updatedList.push_back(updated);
+        }
+        sensorList = std::move(updatedList);
+    }
+
+private:
+    static LegacySensor record(const SensorTable& table, uint8_t i) {
+        LegacySensor sensor = {};
+        memcpy(sensor.address, table.address[i], 8);
+        sensor.temperature = table.raw[i] / 16.0f;
+        sensor.lastValidReading = table.lastValidRaw[i] / 16.0f;
+        sensor.lastReadTime = table.lastReadTime[i];
+        sensor.consecutiveErrors = table.consecutiveErrors[i];
+        sensor.resolution = table.resolution[i];
+        sensor.isActive = true;
+        sensor.valid = table.isValid(i);
+        return sensor;
+    }
+
+    std::vector<LegacySensor> sensorList;
+};
+}
+
+// Heap allocations per collection and per scan on a full bus, for the
+// sensor table and for the lists it replaced. Neither a collection nor a
+// scan of an unchanged bus may touch the heap.
+bool Bench::heap() {
+    std::vector<std::unique_ptr<BusRig>> rigs;
+    rigs.emplace_back(new BusRig(0, MAX_ONEWIRE_SENSORS, 1));
+    BusRig& rig = *rigs.front();
+
+    if (!runCycles(rigs, CYCLES, [](size_t, BusRig&) {})) {
+        printf("heap: bus stalled\n");
+        return false;
+    }
+    const SensorTable& table = rig.manager.getSensorTable();
+
+    uint64_t allocations = Bench::allocations();
+    for (uint32_t s = 0; s < SCANS; s++) {
+        rig.manager.scanDevices();
+    }
+    uint64_t scanAllocations = Bench::allocations() - allocations;
+
+    LegacyLists lists;
+    allocations = Bench::allocations();
+    uint64_t start = Bench::nowNs();
+    for (uint32_t c = 0; c < CYCLES; c++) {
+        lists.read(table);
+    }
+    uint64_t listReadNs = Bench::nowNs() - start;
+    uint64_t listReadAllocations = Bench::allocations() - allocations;
+
+    allocations = Bench::allocations();
+    start = Bench::nowNs();
+    for (uint32_t s = 0; s < SCANS; s++) {
+        lists.scan(table);
+    }
+    uint64_t listScanNs = Bench::nowNs() - start;
+    uint64_t listScanAllocations = Bench::allocations() - allocations;
+
+    printf("heap: %u sensors, %u collections, %u scans\n", table.count, rig.collections, SCANS);
+    printf("  %-8s %14s %12s %12s %12s\n", "", "allocs/collect", "allocs/scan", "us/collect", "us/scan");
+    printf("  %-8s %14.1f %12.1f %12.2f %12.2f\n", "lists", (double)listReadAllocations / CYCLES,
+           (double)listScanAllocations / SCANS, listReadNs / 1000.0 / CYCLES, listScanNs / 1000.0 / SCANS);
+    printf("  %-8s %14.1f %12.1f %12s %12s\n", "table", (double)rig.collectAllocations / rig.collections,
+           (double)scanAllocations / SCANS, "-", "-");
+    printf("  (list times are the container work alone; the lists held %zu B per sensor)\n",
+           sizeof(LegacySensor));
+
+    bool ok = true;
+    if (rig.collectAllocations != 0) {
+        printf("heap: collections made %llu allocations\n", (unsigned long long)rig.collectAllocations);
+        ok = false;
+    }
+    if (scanAllocations != 0) {
+        printf("heap: scans made %llu allocations\n", (unsigned long long)scanAllocations);
+        ok = false;
+    }
+    return ok;
+}
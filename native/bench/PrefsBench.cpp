@@ -0,0 +1,150 @@
+// native/bench/PrefsBench.cpp
+#include <cstdio>
+#include "AuthManager.h"
+#include "Bench.h"
+#include "FilePreferenceStorage.h"
+#include "NetworkTask.h"
+#include "OneWireTask.h"
+#include "PreferencesApiHandler.h"
+#include "PreferencesManager.h"
+
+namespace {
+constexpr uint8_t SENSORS = 16;
+constexpr int NONE = -1;
+
+uint32_t taskMessages = 0;
+
+void rom(uint8_t i, uint8_t* address) {
+    const uint8_t base[8] = {0x28, 0xB3, 0x5C, 0x11, 0x00, 0x00, 0x00, 0x00};
+    memcpy(address, base, 8);
+    address[6] = i;
+}
+
+String romString(uint8_t i) {
+    uint8_t address[8];
+    rom(i, address);
+    return PreferencesManager::addressToString(address);
+}
+
+// A name for every bench sensor, as the settings page posts them; the sensor
+// at renamed gets a new one
+String namesBody(int renamed) {
+    String body = "{\"sensors\":{";
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        if (i) body += ",";
+        body += "\"" + romString(i) + "\":\"Tank " + String(i + 1);
+        if (i == renamed) body += " inlet";
+        body += "\"";
+    }
+    return body + "}}";
+}
+
+String sensorSettingsBody() {
+    String resolutions = "\"resolutions\":{";
+    String filters = "\"filters\":{";
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        if (i) {
+            resolutions += ",";
+            filters += ",";
+        }
+        resolutions += "\"" + romString(i) + "\":10";
+        filters += "\"" + romString(i) + "\":\"median\"";
+    }
+    return "{" + resolutions + "}," + filters + "}}";
+}
+
+// Runs one call, then flushes what it left in the cache, as the flush task
+// would. quiet calls read, repeat or get rejected, and must not write; every
+// other call must be accepted and write, so a parser that silently drops the
+// body cannot pass.
+template <typename Fn>
+bool measure(const char* name, bool quiet, Fn&& call) {
+    FilePreferenceStorage& storage = Bench::preferenceStorage();
+    storage.resetCounters();
+    uint32_t messages = taskMessages;
+
+    bool accepted = call();
+    bool flushed = PreferencesManager::flush();
+
+    // Puts of the stored value count as writes there, but NVS skips them
+    const FilePreferenceStorage::Counters& counters = storage.getCounters();
+    uint32_t writes = counters.writes - counters.redundantWrites;
+    printf("  %-30s %4s %7u %5u %8u %7llu %5u\n", name, accepted ? "yes" : "no", writes,
+           counters.redundantWrites, counters.removes, (unsigned long long)counters.bytesWritten,
+           taskMessages - messages);
+
+    if (!flushed) {
+        printf("prefs: flush failed after '%s'\n", name);
+        return false;
+    }
+    if (quiet && (writes || counters.removes)) {
+        printf("prefs: '%s' changed flash\n", name);
+        return false;
+    }
+    if (!quiet && (!accepted || !writes)) {
+        printf("prefs: '%s' %s\n", name, accepted ? "did not change flash" : "was rejected");
+        return false;
+    }
+    return true;
+}
+}
+
+// The handler posts to these tasks, which do not run on a host; count what
+// it sends instead
+void OneWireTask::sendCommand(const TaskMessage&) {
+    taskMessages++;
+}
+
+bool NetworkTask::enqueuePublication(const TaskMessage&) {
+    taskMessages++;
+    return true;
+}
+
+// Flash writes per call for the settings API, credentials and direct
+// setters, against the file-backed store. Reads, repeats and rejected
+// updates must not write at all.
+bool Bench::prefs() {
+    PreferencesApiHandler handler;
+    const String mqtt = "{\"mqtt\":{\"broker\":\"broker.local\",\"port\":1883,"
+                        "\"username\":\"bench\",\"password\":\"secret\"}}";
+    const String badMqtt = "{\"mqtt\":{\"broker\":\"broker.local\",\"port\":0},"
+                           "\"sensors\":{\"" + romString(3) + "\":\"Tank 4 outlet\"}}";
+
+    if (!PreferencesManager::flush()) {
+        printf("prefs: could not flush earlier changes\n");
+        return false;
+    }
+
+    printf("prefs: %u sensors, writes after each call and a flush\n", SENSORS);
+    printf("  %-30s %4s %7s %5s %8s %7s %5s\n", "", "ok", "writes", "same", "removes", "bytes", "msgs");
+
+    bool ok = true;
+    ok &= measure("auth init, first boot", false, [] { AuthManager::init(); return true; });
+    ok &= measure("auth set credentials", false, [] {
+        return AuthManager::setCredentials("admin", "correct horse");
+    });
+    ok &= measure("auth validate", true, [] {
+        return AuthManager::validateCredentials("admin", "correct horse");
+    });
+    ok &= measure("api post mqtt", false, [&] { return handler.handlePost(mqtt); });
+    ok &= measure("api post mqtt, repeated", true, [&] { return handler.handlePost(mqtt); });
+    ok &= measure("api post 16 names", false, [&] { return handler.handlePost(namesBody(NONE)); });
+    ok &= measure("api post 16 names, repeated", true, [&] { return handler.handlePost(namesBody(NONE)); });
+    ok &= measure("api post 16 names, 1 new", false, [&] { return handler.handlePost(namesBody(0)); });
+    ok &= measure("api post resolutions, filters", false, [&] {
+        return handler.handlePost(sensorSettingsBody());
+    });
+    ok &= measure("api post rejected", true, [&] { return handler.handlePost(badMqtt); });
+    ok &= measure("api get", true, [&] { return !handler.handleGet().isEmpty(); });
+    ok &= measure("prefs same scan interval", true, [] {
+        PreferencesManager::setScanInterval(PreferencesManager::getScanInterval());
+        return true;
+    });
+    ok &= measure("prefs toggle auto scan", false, [] {
+        PreferencesManager::setAutoScanEnabled(!PreferencesManager::getAutoScanEnabled());
+        return true;
+    });
+    printf("  (writes change a value; same: puts of the stored value; msgs: task messages sent)\n");
+
+    return ok;
+}
@@ -0,0 +1,101 @@
+// native/bench/SlotsBench.cpp
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "Bench.h"
+#include "BusRig.h"
+
+namespace {
+constexpr uint32_t CYCLES = 20;
+constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+constexpr uint8_t SCRATCHPAD_SIZE = 9;
+constexpr uint32_t READ_SLOTS = (1 + 8 + 1 + SCRATCHPAD_SIZE) * 8;
+
+// The pattern the batched pass replaced: DallasTemperature::getTempC() per
+// sensor resets, selects and reads the whole scratchpad, then resets again
+// to check the device is still there, all with sensorMutex held
+void perSensorPass(SimulatedOneWireBus& bus, const SensorTable& table) {
+    for (uint8_t i = 0; i < table.count; i++) {
+        bus.reset();
+        bus.select(table.address[i]);
+        bus.write(CMD_READ_SCRATCHPAD, false);
+        for (uint8_t b = 0; b < SCRATCHPAD_SIZE; b++) {
+            bus.read();
+        }
+        bus.reset();
+    }
+}
+
+void printRow(const char* name, const SimulatedOneWireBus::Counters& traffic, uint32_t cycles,
+              double lockUs) {
+    printf("  %-12s %8.1f %8.1f %10.2f %10.1f\n", name, (double)traffic.resets / cycles,
+           (double)BusRig::slots(traffic) / cycles, traffic.busTimeUs / 1000.0 / cycles, lockUs);
+}
+}
+
+// Bus slots and resets per collection with a full bus, for the batched pass
+// and for the per-sensor reads it replaced, and for a bus where devices drop
+// out after the presence pulse. The manager's own CycleStats must agree with
+// what the simulated bus saw.
+bool Bench::slots() {
+    std::vector<std::unique_ptr<BusRig>> rigs;
+    rigs.emplace_back(new BusRig(0, MAX_ONEWIRE_SENSORS, 1));
+    rigs.emplace_back(new BusRig(1, MAX_ONEWIRE_SENSORS, 2));
+    BusRig& rig = *rigs[0];
+    BusRig& dropouts = *rigs[1];
+    SimulatedOneWireBus::Faults faults;
+    faults.dropoutRate = 0.1f;
+    dropouts.bus.setFaults(faults);
+
+    uint64_t statSlots[2] = {};
+    uint64_t statResets[2] = {};
+    uint64_t lockUs[2] = {};
+    bool ok = runCycles(rigs, CYCLES, [&](size_t i, BusRig& r) {
+        const CycleStats& stats = r.manager.getLastCycleStats();
+        statSlots[i] += stats.bitSlots;
+        statResets[i] += stats.resets;
+        lockUs[i] += stats.lockTimeUs;
+    });
+    if (!ok) {
+        printf("slots: bus stalled\n");
+        return false;
+    }
+
+    SimulatedOneWireBus::Counters perSensor = {};
+    for (uint32_t c = 0; c < CYCLES; c++) {
+        SimulatedOneWireBus::Counters before = rig.bus.getCounters();
+        perSensorPass(rig.bus, rig.manager.getSensorTable());
+        BusRig::addTraffic(perSensor, before, rig.bus.getCounters());
+    }
+    const SimulatedOneWireBus::Counters& batched = rig.collectTraffic;
+
+    printf("slots: %u sensors on one bus, %u collections\n",
+           rig.manager.getSensorTable().count, CYCLES);
+    printf("  %-12s %8s %8s %10s %10s\n", "", "resets", "slots", "bus ms", "lock us");
+    printRow("per-sensor", perSensor, CYCLES, perSensor.busTimeUs / (double)CYCLES);
+    printRow("batched", batched, CYCLES, lockUs[0] / (double)CYCLES);
+    printRow("10% dropout", dropouts.collectTraffic, CYCLES, lockUs[1] / (double)CYCLES);
+    printf("  (per-sensor held the mutex for its whole bus pass; batched lock time is measured)\n");
+    printf("  (a full bus reads every byte either way; reads of a dropped-out device stop after 5 of 9 bytes)\n");
+
+    for (size_t i = 0; i < rigs.size(); i++) {
+        const SimulatedOneWireBus::Counters& seen = rigs[i]->collectTraffic;
+        if (statSlots[i] != BusRig::slots(seen) || statResets[i] != seen.resets) {
+            printf("slots: bus %zu CycleStats counted %llu slots and %llu resets, the bus saw %llu and %u\n",
+                   i, (unsigned long long)statSlots[i], (unsigned long long)statResets[i],
+                   (unsigned long long)BusRig::slots(seen), seen.resets);
+            ok = false;
+        }
+    }
+    // Both move the same bytes; the batched pass drops the trailing resets
+    if (BusRig::slots(batched) > BusRig::slots(perSensor) || batched.resets >= perSensor.resets) {
+        printf("slots: batched pass is not cheaper than per-sensor reads\n");
+        ok = false;
+    }
+    // One reset per read; reads of dropped-out devices must stop early
+    if (BusRig::slots(dropouts.collectTraffic) >= (uint64_t)dropouts.collectTraffic.resets * READ_SLOTS) {
+        printf("slots: reads of dropped-out devices were not cut short\n");
+        ok = false;
+    }
+    return ok;
+}
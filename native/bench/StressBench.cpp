@@ -0,0 +1,104 @@
+// native/bench/StressBench.cpp
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "Bench.h"
+#include "BusRig.h"
+
+namespace {
+constexpr size_t BUSES = 32;
+constexpr uint32_t CYCLES = 40;               // Collections per bus
+constexpr uint32_t HOTPLUG_INTERVAL = 5;      // Collections between plug events on a bus
+constexpr float CRC_ERROR_RATE = 0.01f;
+constexpr float DROPOUT_RATE = 0.01f;
+constexpr double MIN_VALID_RATIO = 0.9;
+}
+
+// Hundreds of sensors: every bus full at MAX_ONEWIRE_SENSORS and the first
+// one over it, with CRC errors, dropouts, and a device unplugged and the
+// previous one plugged back in every few cycles. Once all are back, each bus
+// must track every device it has room for.
+bool Bench::stress() {
+    std::vector<std::unique_ptr<BusRig>> rigs;
+    size_t devices = 0;
+    for (size_t i = 0; i < BUSES; i++) {
+        size_t count = MAX_ONEWIRE_SENSORS + (i == 0 ? 1 : 0);
+        rigs.emplace_back(new BusRig((uint8_t)i, count, (uint32_t)i + 1));
+        rigs.back()->bus.setFaults({CRC_ERROR_RATE, DROPOUT_RATE});
+        devices += count;
+    }
+
+    uint64_t tracked = 0;
+    uint64_t valid = 0;
+    uint64_t crcRejected = 0;
+    uint32_t unplugs = 0;
+    bool ok = runCycles(rigs, CYCLES, [&](size_t, BusRig& rig) {
+        tracked += rig.manager.getSensorTable().count;
+        valid += rig.validSensors();
+        crcRejected += rig.manager.getLastCycleStats().crcErrors;
+
+        if (rig.collections % HOTPLUG_INTERVAL == 0) {
+            size_t count = rig.bus.getDeviceCount();
+            size_t event = rig.collections / HOTPLUG_INTERVAL;
+            rig.bus.setPresent((event - 1) % count, true);
+            rig.bus.setPresent(event % count, false);
+            rig.manager.startDiscoveryPass();
+            unplugs++;
+        }
+    });
+    if (!ok) {
+        printf("stress: buses stalled\n");
+        return false;
+    }
+
+    // Everything back on the bus, then one more discovery pass and a few cycles
+    for (auto& rig : rigs) {
+        rig->bus.setFaults({});
+        for (size_t d = 0; d < rig->bus.getDeviceCount(); d++) {
+            rig->bus.setPresent(d, true);
+        }
+        rig->manager.startDiscoveryPass();
+    }
+    ok = runCycles(rigs, CYCLES + 3, [](size_t, BusRig&) {});
+
+    uint64_t collectNs = 0;
+    uint64_t maxCollectNs = 0;
+    SimulatedOneWireBus::Counters total = {};
+    for (auto& rig : rigs) {
+        size_t expected = std::min(rig->bus.getDeviceCount(), MAX_ONEWIRE_SENSORS);
+        if (rig->manager.getSensorTable().count != expected) {
+            printf("stress: bus tracks %u of %zu sensors after replugging\n",
+                   rig->manager.getSensorTable().count, expected);
+            ok = false;
+        }
+        collectNs += rig->collectNs;
+        maxCollectNs = std::max(maxCollectNs, rig->maxCollectNs);
+
+        const SimulatedOneWireBus::Counters& counters = rig->bus.getCounters();
+        total.resets += counters.resets;
+        total.searches += counters.searches;
+        total.crcErrorsInjected += counters.crcErrorsInjected;
+        total.dropouts += counters.dropouts;
+        total.busTimeUs += counters.busTimeUs;
+    }
+
+    uint32_t collections = 0;
+    for (auto& rig : rigs) collections += rig->collections;
+    double validRatio = tracked ? (double)valid / tracked : 0.0;
+
+    printf("stress: %zu buses, %zu sensors, %u collections\n", rigs.size(), devices, collections);
+    printf("  collect     %.1f us/cycle mean, %.1f us max\n",
+           collectNs / 1000.0 / collections, maxCollectNs / 1000.0);
+    printf("  bus         %.2f ms/cycle modeled, %.1f resets/cycle, %u searches\n",
+           total.busTimeUs / 1000.0 / collections, (double)total.resets / collections, total.searches);
+    printf("  faults      %u CRC errors injected, %llu rejected; %u dropouts\n",
+           total.crcErrorsInjected, (unsigned long long)crcRejected, total.dropouts);
+    printf("  hot-plug    %u unplug events\n", unplugs);
+    printf("  readings    %.1f%% of tracked sensors valid\n", validRatio * 100.0);
+
+    if (validRatio < MIN_VALID_RATIO) {
+        printf("stress: fewer than %.0f%% of readings valid\n", MIN_VALID_RATIO * 100.0);
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,82 @@
+// native/bench/main.cpp
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "Bench.h"
+#include "FilePreferenceStorage.h"
+#include "Logger.h"
+#include "PreferencesManager.h"
+
+namespace {
+constexpr const char* PREFERENCES_PATH = "bench_preferences.bin";
+FilePreferenceStorage* storage = nullptr;
+
+struct Scenario {
+    const char* name;
+    bool (*run)();
+    const char* description;
+};
+
+const Scenario SCENARIOS[] = {
+    {"heap", Bench::heap, "heap allocations per collection and scan, before and after"},
+    {"prefs", Bench::prefs, "flash writes per settings, credentials and API call"},
+    {"slots", Bench::slots, "bus slots and resets per collection on a full bus"},
+    {"stress", Bench::stress, "hundreds of sensors, full buses, faults and hot-plug"},
+};
+}
+
+bool Bench::initPreferences() {
+    static bool initialized = false;
+    if (initialized) return true;
+
+    unlink(PREFERENCES_PATH);
+    storage = new FilePreferenceStorage(PREFERENCES_PATH);
+    PreferencesManager::setStorage(storage);
+    PreferencesManager::init();
+    initialized = PreferencesManager::flush();
+    return initialized;
+}
+
+FilePreferenceStorage& Bench::preferenceStorage() {
+    return *storage;
+}
+
+// bench [scenario...]; runs every scenario when none is named
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        bool known = false;
+        for (const Scenario& scenario : SCENARIOS) {
+            known |= strcmp(argv[i], scenario.name) == 0;
+        }
+        if (!known) {
+            printf("Unknown scenario '%s'. Scenarios:\n", argv[i]);
+            for (const Scenario& scenario : SCENARIOS) {
+                printf("  %-8s %s\n", scenario.name, scenario.description);
+            }
+            return 2;
+        }
+    }
+    
+    Logger::setLogLevel(Logger::Level::ERROR);
+    if (!Bench::initPreferences()) {
+        printf("Could not set up preferences in %s\n", PREFERENCES_PATH);
+        return 1;
+    }
+
+    bool ok = true;
+    for (const Scenario& scenario : SCENARIOS) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++) {
+            selected = strcmp(argv[i], scenario.name) == 0;
+        }
+        if (!selected) continue;
+
+        if (!scenario.run()) {
+            printf("%s: FAILED\n", scenario.name);
+            ok = false;
+        }
+        printf("\n");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// native/shims/Arduino.h
+#pragma once
+
+// The parts of the Arduino core the host build uses: String, time, Serial
+// and a few helpers. Only for builds where ARDUINO is not defined.
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "NativeClock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+class String {
+public:
+    String(const char* value = "") : text(value ? value : "") {}
+    String(const std::string& value) : text(value) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : String((unsigned long)value, base) {}
+    explicit String(int value, unsigned char base = 10) : String((long)value, base) {}
+    explicit String(unsigned int value, unsigned char base = 10) : String((unsigned long)value, base) {}
+    explicit String(long value, unsigned char base = 10) {
+        if (value < 0 && base == 10) {
+            text = "-" + toBase((unsigned long)-value, base);
+        } else {
+            text = toBase((unsigned long)value, base);
+        }
+    }
+    explicit String(unsigned long value, unsigned char base = 10) : text(toBase(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : String((long)value, base) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : String((unsigned long)value, base) {}
+    explicit String(float value, unsigned char decimals = 2) : String((double)value, decimals) {}
+    explicit String(double value, unsigned char decimals = 2) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        text = buffer;
+    }
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return (unsigned int)text.length(); }
+    bool isEmpty() const { return text.empty(); }
+    bool reserve(unsigned int size) { text.reserve(size); return true; }
+
+    bool concat(const String& other) { text += other.text; return true; }
+    bool concat(const char* other) { if (!other) return false; text += other; return true; }
+    bool concat(char c) { text += c; return true; }
+
+    String& operator+=(const String& other) { concat(other); return *this; }
+    String& operator+=(const char* other) { concat(other); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= text.length()) return String();
+        return String(text.substr(from, to - from));
+    }
+
+    char operator[](unsigned int index) const { return index < text.length() ? text[index] : '\0'; }
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == (other ? other : ""); }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return text < other.text; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.text); }
+    friend String operator+(const String& a, char b) { return String(a.text + b); }
+
+private:
+    static std::string toBase(unsigned long value, unsigned char base) {
+        if (base < 2 || base > 16) base = 10;
+        char buffer[8 * sizeof(value) + 1];
+        char* end = buffer + sizeof(buffer) - 1;
+        char* p = end;
+        *p = '\0';
+        do {
+            *--p = "0123456789ABCDEF"[value % base];
+            value /= base;
+        } while (value);
+        return std::string(p, end);
+    }
+
+    std::string text;
+};
+
+// Some libraries look for this name next to String
+class StringSumHelper : public String {
+public:
+    using String::String;
+};
+
+typedef uint8_t byte;
+
+// Only the value; nothing on a host resolves or connects
+class IPAddress {
+public:
+    IPAddress() : octets{} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+    uint8_t operator[](int index) const { return octets[index]; }
+
+private:
+    uint8_t octets[4];
+};
+
+// 32 bits, as unsigned long is on the ESP32, so they wrap the same way
+inline uint32_t millis() { return (uint32_t)(NativeClock::nowUs() / 1000); }
+inline uint32_t micros() { return (uint32_t)NativeClock::nowUs(); }
+inline void delay(unsigned long ms) { NativeClock::skipUs((uint64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { NativeClock::skipUs(us); }
+inline void yield() { std::this_thread::yield(); }
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// glibc only has it from 2.38; macOS and the BSDs always do
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+    size_t print(const String& s) { return fputs(s.c_str(), stdout) < 0 ? 0 : s.length(); }
+    size_t println(const String& s = String()) { return print(s) + print("\n"); }
+    void flush() { fflush(stdout); }
+};
+
+inline HardwareSerial Serial;
+
+// Heap figures have no meaning on a host; report plenty
+class EspClass {
+public:
+    uint32_t getFreeHeap() const { return UINT32_MAX; }
+    uint32_t getMinFreeHeap() const { return UINT32_MAX; }
+    uint32_t getMaxAllocHeap() const { return UINT32_MAX; }
+};
+
+inline EspClass ESP;
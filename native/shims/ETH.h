@@ -0,0 +1,5 @@
+// native/shims/ETH.h
+#pragma once
+
+// Declarations only, see WiFi.h
+#include "WiFi.h"
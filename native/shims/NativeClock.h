@@ -0,0 +1,29 @@
+// native/shims/NativeClock.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Time for host builds. It runs with the wall clock, but a task that waits
+// skips ahead instead of sleeping, so simulated conversions cost no real time
+// while the work between waits is still timed.
+namespace NativeClock {
+
+inline std::atomic<uint64_t>& skippedUs() {
+    static std::atomic<uint64_t> skipped{0};
+    return skipped;
+}
+
+inline uint64_t nowUs() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    uint64_t elapsed = (uint64_t)duration_cast<microseconds>(steady_clock::now() - start).count();
+    return elapsed + skippedUs().load(std::memory_order_relaxed);
+}
+
+inline void skipUs(uint64_t us) {
+    skippedUs().fetch_add(us, std::memory_order_relaxed);
+}
+
+}  // namespace NativeClock
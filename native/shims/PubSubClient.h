@@ -0,0 +1,10 @@
+// native/shims/PubSubClient.h
+#pragma once
+
+// Declarations only, see WiFi.h. Never connected.
+#include <Arduino.h>
+
+class PubSubClient {
+public:
+    bool connected() { return false; }
+};
@@ -0,0 +1,10 @@
+// native/shims/TM1637.h
+#pragma once
+
+// Declarations only: host builds have no display
+#include <Arduino.h>
+
+class TM1637 {
+public:
+    TM1637(uint8_t, uint8_t) {}
+};
@@ -0,0 +1,8 @@
+// native/shims/WiFi.h
+#pragma once
+
+#include <Arduino.h>
+
+// Enough for the network classes to be declared. Host builds never start the
+// network, so nothing here does anything.
+typedef int WiFiEvent_t;
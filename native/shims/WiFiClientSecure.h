@@ -0,0 +1,7 @@
+// native/shims/WiFiClientSecure.h
+#pragma once
+
+// Declarations only, see WiFi.h
+#include "WiFi.h"
+
+class WiFiClientSecure {};
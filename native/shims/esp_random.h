@@ -0,0 +1,11 @@
+// native/shims/esp_random.h
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+// The hardware generator, from the host's entropy source
+inline uint32_t esp_random() {
+    static std::random_device device;
+    return device();
+}
@@ -0,0 +1,8 @@
+// native/shims/freertos/queue.h
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Only the handle type; host builds do not run the tasks that own queues
+struct NativeQueue;
+typedef NativeQueue* QueueHandle_t;
@@ -0,0 +1,35 @@
+// native/shims/freertos/semphr.h
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+// Mutexes as timed std::mutexes. As on the device, taking a mutex the caller
+// already holds waits out the timeout and fails.
+struct NativeSemaphore {
+    std::timed_mutex mutex;
+};
+
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new NativeSemaphore();
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
@@ -0,0 +1,51 @@
+// native/shims/freertos/task.h
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include "FreeRTOS.h"
+#include "NativeClock.h"
+
+// Tasks are created but never started: a host benchmark calls the work it
+// measures itself (e.g. PreferencesManager::flush()), so its results do not
+// depend on thread scheduling. Notifications are counted for inspection.
+struct NativeTask {
+    const char* name;
+    std::atomic<uint32_t> notifications{0};
+};
+
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char* name, uint32_t, void*,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    NativeTask* task = new NativeTask();
+    task->name = name;
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack, 
+                              void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stack, parameter, priority, handle, 0);
+}
+
+inline void xTaskNotifyGive(TaskHandle_t task) {
+    if (task) task->notifications.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Only reachable from a task body, which never runs here
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) {
+    return 0;
+}
+
+// Waits skip ahead on the clock instead of sleeping
+inline void vTaskDelay(TickType_t ticks) {
+    NativeClock::skipUs((uint64_t)ticks * 1000);
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)(NativeClock::nowUs() / 1000);
+}
+
+#define taskYIELD() std::this_thread::yield()
@@ -1,7 +1,7 @@
 // src/ControlTask.cpp
 #include "ControlTask.h"
 #include "PreferencesManager.h"
-#include "OneWireTask.h"
+#include "SensorRegistry.h"
 #include "NetworkTask.h"
 #include <cstring>
 #include <cstddef>
@@ -51,13 +51,14 @@ void ControlTask::start() {
     Logger::info("Starting ControlTask creation");
     
     TaskHandle_t taskHandle;
-    BaseType_t result = xTaskCreate(
+    BaseType_t result = xTaskCreatePinnedToCore(
         taskFunction,
         "ControlTask",
         CONTROL_TASK_STACK_SIZE,
         nullptr,
         CONTROL_TASK_PRIORITY,
-        &taskHandle
+        &taskHandle,
+        CONTROL_TASK_CORE
     );
     
     if (result != pdPASS) {
@@ -103,6 +104,7 @@ void ControlTask::taskFunction(void* parameter) {
         }
         
         // Update physical relay states if needed
+        bool relayChanged[2] = {false, false};
         if (xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             for (int i = 0; i < 2; i++) {
                 if (relayStates[i].requested != relayStates[i].actual) {
@@ -111,6 +113,7 @@ void ControlTask::taskFunction(void* parameter) {
                     
                     relayStates[i].actual = relayStates[i].requested;
                     relayStates[i].lastChangeTime = millis();
+                    relayChanged[i] = true;
                     
                     Logger::info("Relay " + String(i) + " state changed to " + 
                                String(relayStates[i].actual ? "ON" : "OFF"));
@@ -119,6 +122,16 @@ void ControlTask::taskFunction(void* parameter) {
             xSemaphoreGive(stateMutex);
         }
         
+        // Publish changes right away instead of waiting for the periodic refresh
+        for (uint8_t i = 0; i < 2; i++) {
+            if (!relayChanged[i]) continue;
+            TaskMessage stateMsg;
+            stateMsg.type = MessageType::RELAY_STATE;
+            stateMsg.data.relayState.id = i;
+            stateMsg.data.relayState.state = getRelayState(i);
+            NetworkTask::enqueuePublication(stateMsg);
+        }
+        
         // Get current preferences
         PreferencesManager::getDisplaySensor(displaySensorAddr);
         
@@ -143,26 +156,16 @@ void ControlTask::taskFunction(void* parameter) {
             lastPublishedTemp = -999.0f;
         }
         
-        // Get sensor list
-        const auto& sensors = OneWireTask::getManager().getSensorList();
-
         // Find the selected sensor
-        bool sensorFound = false;
-        for (const auto& sensor : sensors) {
-            if (memcmp(sensor.address, currentSensorAddr, 8) == 0) {
-                sensorFound = true;
-                if (sensor.valid) {
-                    float currentTemp = sensor.temperature;
-                    display.setTemperature(currentTemp);
-                } else {
-                    display.showMessage("ERR");
-                    Logger::warning("Selected sensor reading invalid");
-                    
-                break;
+        TemperatureSensor sensor;
+        if (SensorRegistry::findSensor(currentSensorAddr, sensor)) {
+            if (sensor.valid) {
+                display.setTemperature(sensor.temperatureRaw);
+            } else {
+                display.showMessage("ERR");
+                Logger::warning("Selected sensor reading invalid");
             }
-        }
-        
-        if (!sensorFound) {
+        } else {
             bool isEmpty = true;
             for (int i = 0; i < 8; i++) {
                 if (currentSensorAddr[i] != 0) {
@@ -171,7 +174,9 @@ void ControlTask::taskFunction(void* parameter) {
                 }
             }
             
-            if (isEmpty && !sensors.empty()) {
+            const auto sensors = isEmpty ? SensorRegistry::getSensors() 
+                                         : std::vector<TemperatureSensor>();
+            if (!sensors.empty()) {
                 // Auto-select first sensor if none configured
                 PreferencesManager::setDisplaySensor(sensors[0].address);
                 memcpy(currentSensorAddr, sensors[0].address, 8);
@@ -179,9 +184,9 @@ void ControlTask::taskFunction(void* parameter) {
                 delay(500);
             } else {
                 display.showMessage("LOST");
-                }
             }
-        } 
+        }
+        
         vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(DISPLAY_UPDATE_INTERVAL));
     }
 }
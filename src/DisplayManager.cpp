@@ -4,7 +4,7 @@
 
 DisplayManager::DisplayManager(uint8_t clkPin, uint8_t dioPin)
     : display(clkPin, dioPin)
-    , currentTemp(0.0f) {
+    , currentRaw(0) {
 }
 
 void DisplayManager::init() {
@@ -20,23 +20,17 @@ void DisplayManager::init() {
 }
 
 void DisplayManager::update() {
-    char tempStr[5];  // Buffer for temperature string
+    char tempStr[FixedPoint::TEMP_BUFFER_SIZE];  // Buffer for temperature string
     
-    if (currentTemp < -9.9 || currentTemp > 99.9) {
+    // Four digits: -9.9 to 99.9
+    int16_t tenths = FixedPoint::toTenths(currentRaw);
+    if (tenths < -99 || tenths > 999) {
         showMessage("ERR");
         return;
     }
     
     // Format temperature with one decimal place
-    int temp = abs(round(currentTemp * 10));
-    int whole = temp / 10;
-    int decimal = temp % 10;
-    
-    if (currentTemp < 0) {
-        snprintf(tempStr, sizeof(tempStr), "-%d.%d", whole, decimal);
-    } else {
-        snprintf(tempStr, sizeof(tempStr), "%d.%d", whole, decimal);
-    }
+    FixedPoint::formatTemperature(currentRaw, 1, tempStr);
     
     showMessage(tempStr);
     Logger::info("Display update: " + String(tempStr));
@@ -47,9 +41,9 @@ void DisplayManager::showMessage(const char* text) {
     Logger::info("Display message: " + String(text));
 }
 
-void DisplayManager::setTemperature(float temp) {
-    if (temp != currentTemp) {
-        currentTemp = temp;
+void DisplayManager::setTemperature(int16_t temperatureRaw) {
+    if (temperatureRaw != currentRaw) {
+        currentRaw = temperatureRaw;
         update();
     }
 }
@@ -0,0 +1,42 @@
+// src/ESP32OneWireBus.cpp
+#include "ESP32OneWireBus.h"
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+void ESP32OneWireBus::begin() {
+    pinMode(pin, INPUT_PULLUP);
+    vTaskDelay(pdMS_TO_TICKS(100));  // Allow bus to stabilize
+}
+
+bool ESP32OneWireBus::reset() {
+    return oneWire.reset() != 0;
+}
+
+void ESP32OneWireBus::select(const uint8_t* rom) {
+    oneWire.select(rom);
+}
+
+void ESP32OneWireBus::skip() {
+    oneWire.skip();
+}
+
+void ESP32OneWireBus::write(uint8_t value, bool power) {
+    oneWire.write(value, power ? 1 : 0);
+}
+
+uint8_t ESP32OneWireBus::read() {
+    return oneWire.read();
+}
+
+uint8_t ESP32OneWireBus::readBit() {
+    return oneWire.read_bit();
+}
+
+void ESP32OneWireBus::resetSearch() {
+    oneWire.reset_search();
+}
+
+bool ESP32OneWireBus::search(uint8_t* rom, bool alarmOnly) {
+    return oneWire.search(rom, !alarmOnly);
+}
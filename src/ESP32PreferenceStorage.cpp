@@ -42,4 +42,14 @@ uint32_t ESP32PreferenceStorage::getUInt(const char* key, uint32_t defaultValue)
 
 bool ESP32PreferenceStorage::remove(const char* key) {
     return prefs.remove(key);
-}
\ No newline at end of file
+}
+
+size_t ESP32PreferenceStorage::putBytes(const char* key, const void* value, size_t len) {
+    return prefs.putBytes(key, value, len);
+}
+
+size_t ESP32PreferenceStorage::getBytes(const char* key, void* buffer, size_t maxLen) {
+    // Preferences logs an error for missing keys; a missing blob is normal here
+    if (!prefs.isKey(key)) return 0;
+    return prefs.getBytes(key, buffer, maxLen);
+}
@@ -0,0 +1,239 @@
+// src/FilePreferenceStorage.cpp
+#ifndef ARDUINO
+
+#include "FilePreferenceStorage.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+FilePreferenceStorage::FilePreferenceStorage(const char* path, uint32_t seed)
+    : path{}
+    , fd(-1)
+    , base(nullptr)
+    , ns{}
+    , readOnly(false)
+    , faults{}
+    , counters{}
+    , rng(seed ? seed : 1) {
+    strncpy(this->path, path, sizeof(this->path) - 1);
+}
+
+FilePreferenceStorage::~FilePreferenceStorage() {
+    unmap();
+}
+
+// Creates the file on first use. A file from another layout is wiped, as
+// NVS is erased when its format changes.
+bool FilePreferenceStorage::map() {
+    if (base) return true;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < FILE_SIZE && ftruncate(fd, FILE_SIZE) != 0)) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapped);
+
+    Header* header = reinterpret_cast<Header*>(base);
+    if (header->magic != MAGIC || header->version != VERSION || header->slotCount != SLOT_COUNT) {
+        memset(base, 0, FILE_SIZE);
+        header->magic = MAGIC;
+        header->version = VERSION;
+        header->slotCount = SLOT_COUNT;
+    }
+    return true;
+}
+
+void FilePreferenceStorage::unmap() {
+    if (base) {
+        msync(base, FILE_SIZE, MS_SYNC);
+        munmap(base, FILE_SIZE);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// Like Preferences, begin() again just switches namespace
+bool FilePreferenceStorage::begin(const char* name, bool readOnly) {
+    if (!validKey(name) || !map()) return false;
+
+    strncpy(ns, name, sizeof(ns) - 1);
+    this->readOnly = readOnly;
+    return true;
+}
+
+FilePreferenceStorage::Slot* FilePreferenceStorage::slotAt(size_t index) const {
+    return reinterpret_cast<Slot*>(base + sizeof(Header) + index * sizeof(Slot));
+}
+
+// Slot of a key in the current namespace, including a removed one
+FilePreferenceStorage::Slot* FilePreferenceStorage::find(const char* key) const {
+    for (size_t i = 0; i < SLOT_COUNT; i++) {
+        Slot* slot = slotAt(i);
+        if (slot->type != Type::UNUSED && strncmp(slot->ns, ns, KEY_SIZE) == 0 &&
+            strncmp(slot->key, key, KEY_SIZE) == 0) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+bool FilePreferenceStorage::validKey(const char* key) const {
+    return key && key[0] != '\0' && strlen(key) < KEY_SIZE;
+}
+
+bool FilePreferenceStorage::write(const char* key, Type type, const void* value, size_t len) {
+    if (!base || readOnly || !validKey(key) || len > MAX_VALUE_SIZE) return false;
+    sleepUs(faults.writeLatencyUs);
+
+    Slot* slot = find(key);
+    for (size_t i = 0; i < SLOT_COUNT && !slot; i++) {
+        if (slotAt(i)->type == Type::UNUSED) slot = slotAt(i);
+    }
+    for (size_t i = 0; i < SLOT_COUNT && !slot; i++) {
+        if (slotAt(i)->type == Type::FREE) slot = slotAt(i);
+    }
+    if (!slot || chance(faults.writeFailureRate)) {
+        counters.failedWrites++;
+        return false;
+    }
+
+    bool sameKey = strncmp(slot->key, key, KEY_SIZE) == 0 && strncmp(slot->ns, ns, KEY_SIZE) == 0;
+    if (sameKey && slot->type == type && slot->length == len && memcmp(slot->data, value, len) == 0) {
+        counters.redundantWrites++;
+    }
+    if (!sameKey) {
+        memcpy(slot->ns, ns, KEY_SIZE);
+        memset(slot->key, 0, KEY_SIZE);
+        strncpy(slot->key, key, KEY_SIZE - 1);
+        slot->writes = 0;
+    }
+    memcpy(slot->data, value, len);
+    slot->length = (uint16_t)len;
+    slot->type = type;
+    slot->writes++;
+
+    counters.writes++;
+    counters.bytesWritten += len;
+    return true;
+}
+
+bool FilePreferenceStorage::putString(const char* key, const char* value) {
+    if (!value) return false;
+    return write(key, Type::STRING, value, strlen(value) + 1);
+}
+
+String FilePreferenceStorage::getString(const char* key, const char* defaultValue) {
+    if (!base || !validKey(key)) return String(defaultValue);
+    sleepUs(faults.readLatencyUs);
+    counters.reads++;
+
+    const Slot* slot = find(key);
+    if (!slot || slot->type != Type::STRING) return String(defaultValue);
+    return String(reinterpret_cast<const char*>(slot->data));
+}
+
+bool FilePreferenceStorage::putUInt(const char* key, uint32_t value) {
+    return write(key, Type::UINT, &value, sizeof(value));
+}
+
+uint32_t FilePreferenceStorage::getUInt(const char* key, uint32_t defaultValue) {
+    if (!base || !validKey(key)) return defaultValue;
+    sleepUs(faults.readLatencyUs);
+    counters.reads++;
+
+    const Slot* slot = find(key);
+    if (!slot || slot->type != Type::UINT) return defaultValue;
+    uint32_t value;
+    memcpy(&value, slot->data, sizeof(value));
+    return value;
+}
+
+bool FilePreferenceStorage::remove(const char* key) {
+    if (!base || readOnly || !validKey(key)) return false;
+    sleepUs(faults.writeLatencyUs);
+
+    Slot* slot = find(key);
+    if (!slot || slot->type == Type::FREE) return false;
+    if (chance(faults.writeFailureRate)) {
+        counters.failedWrites++;
+        return false;
+    }
+    slot->type = Type::FREE;
+    slot->length = 0;
+    counters.removes++;
+    return true;
+}
+
+size_t FilePreferenceStorage::putBytes(const char* key, const void* value, size_t len) {
+    if (!value || len == 0) return 0;
+    return write(key, Type::BLOB, value, len) ? len : 0;
+}
+
+size_t FilePreferenceStorage::getBytes(const char* key, void* buffer, size_t maxLen) {
+    if (!base || !validKey(key)) return 0;
+    sleepUs(faults.readLatencyUs);
+    counters.reads++;
+
+    const Slot* slot = find(key);
+    if (!slot || slot->type != Type::BLOB || !buffer || slot->length > maxLen) return 0;
+    memcpy(buffer, slot->data, slot->length);
+    return slot->length;
+}
+
+uint32_t FilePreferenceStorage::getWear(const char* key) const {
+    if (!base || !validKey(key)) return 0;
+    const Slot* slot = find(key);
+    return slot ? slot->writes : 0;
+}
+
+size_t FilePreferenceStorage::getWear(KeyWear* out, size_t maxKeys) const {
+    if (!base) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SLOT_COUNT && count < maxKeys; i++) {
+        const Slot* slot = slotAt(i);
+        if (slot->type == Type::UNUSED || strncmp(slot->ns, ns, KEY_SIZE) != 0) continue;
+        memcpy(out[count].key, slot->key, KEY_SIZE);
+        out[count].writes = slot->writes;
+        count++;
+    }
+    return count;
+}
+
+// xorshift32, as in SimulatedOneWireBus
+uint32_t FilePreferenceStorage::nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+bool FilePreferenceStorage::chance(float probability) {
+    if (probability <= 0.0f) return false;
+    return (nextRandom() & 0xFFFFFF) < (uint32_t)(probability * 0x1000000);
+}
+
+void FilePreferenceStorage::sleepUs(uint32_t us) const {
+    if (us) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+#endif // ARDUINO
@@ -1,5 +1,6 @@
 // src/Logger.cpp
 #include "Logger.h"
+#include <cstdarg>
 
 // Initialize static members
 Logger::Level Logger::currentLevel = Logger::Level::INFO;
@@ -19,23 +20,41 @@ void Logger::disableCategory(Category category) {
 }
 
 void Logger::error(const String& message, Category category) {
-    logMessage(Level::ERROR, category, message);
+    logMessage(Level::ERROR, category, message.c_str());
 }
 
 void Logger::warning(const String& message, Category category) {
-    logMessage(Level::WARNING, category, message);
+    logMessage(Level::WARNING, category, message.c_str());
 }
 
 void Logger::info(const String& message, Category category) {
-    logMessage(Level::INFO, category, message);
+    logMessage(Level::INFO, category, message.c_str());
 }
 
 void Logger::debug(const String& message, Category category) {
-    logMessage(Level::DEBUG, category, message);
+    logMessage(Level::DEBUG, category, message.c_str());
 }
 
 void Logger::trace(const String& message, Category category) {
-    logMessage(Level::TRACE, category, message);
+    logMessage(Level::TRACE, category, message.c_str());
+}
+
+void Logger::logf(Level level, Category category, const char* format, ...) {
+    if (!isEnabled(level, category)) {
+        return;
+    }
+    
+    char message[LOGF_BUFFER_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    logMessage(level, category, message);
+}
+
+bool Logger::isEnabled(Level level, Category category) {
+    return static_cast<int>(level) <= static_cast<int>(currentLevel) && 
+           isCategoryEnabled(category);
 }
 
 const char* Logger::getLevelString(Level level) {
@@ -64,10 +83,9 @@ bool Logger::isCategoryEnabled(Category category) {
     return (enabledCategories & (1 << static_cast<uint8_t>(category))) != 0;
 }
 
-void Logger::logMessage(Level level, Category category, const String& message) {
+void Logger::logMessage(Level level, Category category, const char* message) {
     // Check if this message should be logged based on level and category
-    if (static_cast<int>(level) > static_cast<int>(currentLevel) || 
-        !isCategoryEnabled(category)) {
+    if (!isEnabled(level, category)) {
         return;
     }
     
@@ -91,5 +109,5 @@ void Logger::logMessage(Level level, Category category, const String& message) {
                  timeStr,
                  getLevelString(level),
                  getCategoryString(category),
-                 message.c_str());
+                 message);
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include "MDNSManager.h"
 
 bool MDNSManager::initialized = false;
-uint32_t MDNSManager::lastUpdate = 0;
 
 bool MDNSManager::init() {
     if (initialized) {
@@ -38,23 +37,19 @@ bool MDNSManager::init() {
     Logger::info("Added HTTP service with device information");
 
     initialized = true;
-    lastUpdate = millis();
     Logger::info("mDNS responder started successfully");
     return true;
 }
+// Called by the network task every UPDATE_INTERVAL
 void MDNSManager::update() {
     if (!initialized) {
         return;
     }
 
-    uint32_t now = millis();
-    if (now - lastUpdate >= UPDATE_INTERVAL) {
-        // For ESP32, just ensure MDNS is running
-        if (!MDNS.begin(MDNS_HOSTNAME)) {
-            Logger::warning("mDNS responder restart failed");
-            initialized = false;
-        }
-        lastUpdate = now;
+    // For ESP32, just ensure MDNS is running
+    if (!MDNS.begin(MDNS_HOSTNAME)) {
+        Logger::warning("mDNS responder restart failed");
+        initialized = false;
     }
 }
 
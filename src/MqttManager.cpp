@@ -3,7 +3,7 @@
 #include "certificates.h"
 #include "PreferencesManager.h"
 #include <algorithm>
-#include "OneWireTask.h"
+#include "SensorRegistry.h"
 #include <ArduinoJson.h>
 #include <vector>
 
@@ -131,6 +131,11 @@ bool MqttManager::resolveServer() {
     return false;
 }
 
+uint32_t MqttManager::msUntilReconnect() const {
+    unsigned long elapsed = millis() - lastConnectAttempt;
+    return elapsed >= reconnectDelay ? 0 : reconnectDelay - elapsed;
+}
+
 bool MqttManager::maintainConnection() {
     static unsigned long lastReport = 0;
     static int lastState = -99;
@@ -236,15 +241,18 @@ void MqttManager::publishTelemetryBatch(const std::vector<TemperatureSensor>& se
     // Calculate required buffer size
     size_t requiredSize = JSON_OBJECT_SIZE(sensors.size());  // Base object
     for (const auto& sensor : sensors) {
-        requiredSize += JSON_OBJECT_SIZE(1) + 20;  // Per sensor entry + address string
+        // Per sensor entry + address string + copied value
+        requiredSize += JSON_OBJECT_SIZE(1) + 20 + FixedPoint::TEMP_BUFFER_SIZE;
     }
     
     DynamicJsonDocument doc(requiredSize);
     
+    char tempStr[FixedPoint::TEMP_BUFFER_SIZE];
     for (const auto& sensor : sensors) {
         if (sensor.valid) {
             String addr = addressToString(sensor.address);
-            doc[addr] = sensor.temperature;
+            FixedPoint::formatTemperature(sensor.temperatureRaw, FixedPoint::JSON_DECIMALS, tempStr);
+            doc[addr] = serialized(String(tempStr));
         }
     }
     
@@ -321,7 +329,7 @@ bool MqttManager::connect() {
         }
         
         // Force immediate metadata publication on connection
-        const auto& sensors = OneWireTask::getManager().getSensorList();
+        const auto sensors = SensorRegistry::getSensors();
         startBatchPublish();
         for (const auto& sensor : sensors) {
             publishSensorMetadata(sensor);
@@ -427,7 +435,7 @@ void MqttManager::publishSensorMetadata(const TemperatureSensor& sensor) {
     String configTopic = createHADiscoveryTopic(sensor.address);
     
     // Get friendly name from preferences
-    String friendlyName = PreferencesManager::getSensorName(sensor.address);
+    String friendlyName = SensorRegistry::getSensorName(sensor.address);
     String displayName = friendlyName.length() > 0 ? friendlyName : "Temperature Sensor " + sensorId;
     
     StaticJsonDocument<768> doc;
@@ -600,8 +608,8 @@ void MqttManager::publishSensorData(const TemperatureSensor& sensor) {
     
     if (sensor.valid) {
         // Home Assistant format
-        char tempStr[10];
-        snprintf(tempStr, sizeof(tempStr), "%.1f", sensor.temperature);
+        char tempStr[FixedPoint::TEMP_BUFFER_SIZE];
+        FixedPoint::formatTemperature(sensor.temperatureRaw, FixedPoint::STATE_DECIMALS, tempStr);
         String haTopic = createSensorTopic(sensor.address) + "/temperature";
         if (publish(haTopic.c_str(), tempStr, true)) {
             Logger::debug("Published sensor: " + String(tempStr));
@@ -610,14 +618,16 @@ void MqttManager::publishSensorData(const TemperatureSensor& sensor) {
         // Check if this is the display sensor and update BabelSensor
         uint8_t displaySensorAddr[8];
         PreferencesManager::getDisplaySensor(displaySensorAddr);
-        if (memcmp(sensor.address, displaySensorAddr, 8) == 0) {
-            publishBabelSensorState(sensor.temperature);
-            Logger::debug("Updated BabelSensor with temperature: " + String(sensor.temperature));
+        if (SensorRegistry::romKey(sensor.address) == SensorRegistry::romKey(displaySensorAddr)) {
+            publishBabelSensorState(sensor.temperatureRaw);
+            Logger::debug("Updated BabelSensor with temperature: " + String(tempStr));
         }
 
         // ThingsBoard format
+        char tbTemp[FixedPoint::TEMP_BUFFER_SIZE];
+        FixedPoint::formatTemperature(sensor.temperatureRaw, FixedPoint::JSON_DECIMALS, tbTemp);
         DynamicJsonDocument doc(128);
-        doc[addressToString(sensor.address)] = sensor.temperature;
+        doc[addressToString(sensor.address)] = serialized(tbTemp);
         String tbPayload;
         serializeJson(doc, tbPayload);
         publish(createTBTelemetryTopic().c_str(), tbPayload.c_str(), false);
@@ -686,11 +696,11 @@ void MqttManager::publishBabelSensorMetadata() {
     publish(configTopic.c_str(), payload.c_str(), true);
 }
 
-void MqttManager::publishBabelSensorState(float temperature) {
+void MqttManager::publishBabelSensorState(int16_t temperatureRaw) {
     if (!isConnected()) return;
     
-    char tempStr[10];
-    snprintf(tempStr, sizeof(tempStr), "%.1f", temperature);
+    char tempStr[FixedPoint::TEMP_BUFFER_SIZE];
+    FixedPoint::formatTemperature(temperatureRaw, FixedPoint::STATE_DECIMALS, tempStr);
     String topic = createBabelSensorTopic() + "/temperature";
     
     publish(topic.c_str(), tempStr, true);
@@ -1,29 +1,36 @@
 // src/NetworkTask.cpp
 #include "NetworkTask.h"
-#include "OneWireTask.h"
+#include "SensorRegistry.h"
 #include "ControlTask.h"
 #include "Logger.h"
 #include "SystemHealth.h"
 #include "NtpManager.h"
 #include "MDNSManager.h"
 #include <ESPmDNS.h>
+#include <ETH.h>
+#include <algorithm>
 
 // Static member initializations
 MqttManager NetworkTask::mqttManager;
-QueueHandle_t NetworkTask::publishQueue = nullptr;
+PublishBuffer NetworkTask::publishBuffer;
 QueueHandle_t NetworkTask::controlQueue = nullptr;
+TaskHandle_t NetworkTask::taskHandle = nullptr;
+TimerWheel NetworkTask::timers;
+NetworkTask::PublishedSensor NetworkTask::published[MAX_TOTAL_SENSORS] = {};
+uint32_t NetworkTask::publishedGeneration = 0;
 
 void NetworkTask::init() {
     Logger::info("Starting Network task initialization");
     
-    publishQueue = xQueueCreate(20, sizeof(TaskMessage));
     controlQueue = xQueueCreate(10, sizeof(TaskMessage));
     
-    if (!publishQueue || !controlQueue) {
+    if (!publishBuffer.init() || !controlQueue) {
         Logger::error("Failed to create queues");
         return;
     }
     Logger::info("Network queues created");
+    
+    WiFi.onEvent(onNetworkEvent);
 
     // Try initial MDNS setup
     if (!MDNSManager::init()) {
@@ -37,43 +44,162 @@ void NetworkTask::init() {
     Logger::info("Network initialization complete");
 }
 
+// Relay states are coalesced per relay; anything else is an event that is
+// delivered in order
 bool NetworkTask::enqueuePublication(const TaskMessage& msg) {
-    if (!publishQueue) return false;
-    return xQueueSend(publishQueue, &msg, 0) == pdTRUE;
+    if (msg.type == MessageType::RELAY_STATE) {
+        if (!publishBuffer.post(msg.data.relayState.id, msg)) return false;
+        notify(EVENT_RELAY);
+        return true;
+    }
+    
+    if (!publishBuffer.pushEvent(msg)) {
+        Logger::warning("Publish event dropped, buffer full");
+        return false;
+    }
+    notify(EVENT_PUBLISH);
+    return true;
+}
+
+PublishBuffer::Counters NetworkTask::getPublishCounters() {
+    return publishBuffer.getCounters();
+}
+
+void NetworkTask::notify(uint32_t events) {
+    if (taskHandle) {
+        xTaskNotify(taskHandle, events, eSetBits);
+    }
+}
+
+// Runs on the system event task
+void NetworkTask::onNetworkEvent(WiFiEvent_t event) {
+    switch (event) {
+        case ARDUINO_EVENT_ETH_CONNECTED:
+        case ARDUINO_EVENT_ETH_DISCONNECTED:
+        case ARDUINO_EVENT_ETH_GOT_IP:
+            notify(EVENT_LINK);
+            break;
+        default:
+            break;
+    }
 }
 
 void NetworkTask::start() {
-    xTaskCreate(
+    xTaskCreatePinnedToCore(
         taskFunction,
         "NetworkTask",
         NETWORK_TASK_STACK_SIZE,
         nullptr,
         NETWORK_TASK_PRIORITY,
-        nullptr
+        &taskHandle,
+        NETWORK_TASK_CORE
     );
 }
 
+void NetworkTask::drainPublishBuffer() {
+    TaskMessage msg;
+    while (publishBuffer.take(msg)) {
+        if (msg.type == MessageType::RELAY_STATE) {
+            mqttManager.publishRelayState(msg.data.relayState.id, 
+                                        msg.data.relayState.state);
+        } else if (msg.type == MessageType::SENSOR_CONFIG_CHANGED) {
+            // Names show up in the discovery metadata
+            mqttManager.startBatchPublish();
+            for (const auto& sensor : SensorRegistry::getSensors()) {
+                mqttManager.publishSensorMetadata(sensor);
+            }
+            mqttManager.endBatchPublish();
+        }
+    }
+}
+
+// Publish the sensors read since they were last sent. Only the registry
+// generation is compared when nothing changed; a refresh also resends
+// sensors that have not been published for PUBLISH_INTERVAL.
+void NetworkTask::publishSnapshot(uint32_t now, bool refresh) {
+    uint32_t current = SensorRegistry::getGeneration();
+    if (current == publishedGeneration && !refresh) return;
+    publishedGeneration = current;
+    
+    bool batchStarted = false;
+    for (size_t slot = 0; slot < MAX_TOTAL_SENSORS; slot++) {
+        PublishedSensor& record = published[slot];
+        TemperatureSensor sensor;
+        if (!SensorRegistry::getSensor(slot, sensor)) {
+            record.key = 0;
+            continue;
+        }
+        
+        uint64_t key = SensorRegistry::romKey(sensor.address);
+        bool due = key != record.key || sensor.lastReadTime != record.readTime ||
+                   (refresh && now - record.publishedAt >= PUBLISH_INTERVAL);
+        if (!due) continue;
+        
+        if (!batchStarted) {
+            mqttManager.startBatchPublish();
+            batchStarted = true;
+        }
+        mqttManager.publishSensorData(sensor);
+        record.key = key;
+        record.readTime = sensor.lastReadTime;
+        record.publishedAt = now;
+    }
+    
+    if (batchStarted) {
+        mqttManager.endBatchPublish();
+    }
+}
+
+// Forget what was sent so the next snapshot goes out in full
+void NetworkTask::resetPublished() {
+    memset(published, 0, sizeof(published));
+    publishedGeneration = SensorRegistry::getGeneration() - 1;
+}
+
+// Sleeps on the task notification until new data or a link change wakes it,
+// or until the next timer is due
 void NetworkTask::taskFunction(void* parameter) {
-    TickType_t lastWakeTime = xTaskGetTickCount();
-    const TickType_t connectionCheckInterval = pdMS_TO_TICKS(5000);
-    const TickType_t publishInterval = pdMS_TO_TICKS(30000);  // 30 second data publish
-    const uint32_t hadPublishInterval = 300000;  // 5 minutes HAD publish
-    uint32_t lastPublishTime = 0;
-    uint32_t lastHADPublishTime = 0;
+    const uint8_t mdnsTimer = timers.add("mdns", MDNSManager::UPDATE_INTERVAL, 1000);
+    const uint8_t ntpTimer = timers.add("ntpRetry", 0);
+    const uint8_t reconnectTimer = timers.add("mqttReconnect", 0);
+    const uint8_t pollTimer = timers.add("mqttPoll", MQTT_POLL_INTERVAL, 50);
+    const uint8_t publishTimer = timers.add("publish", PUBLISH_INTERVAL, 1000);
+    const uint8_t hadTimer = timers.add("hadMetadata", HAD_PUBLISH_INTERVAL, 5000);
+    
     bool mqttInitialized = false;
+    bool wasConnected = false;
     
     Logger::info("Network task starting");
     
+    uint32_t now = millis();
+    timers.start(mdnsTimer, now, 0);
+    timers.start(ntpTimer, now, 0);
+    
     while (true) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, 
+                        pdMS_TO_TICKS(timers.msUntilNext(millis(), IDLE_WAIT)));
+        now = millis();
+        uint32_t due = timers.runDue(now);
+        
+        if (events & EVENT_LINK) {
+            Logger::info("Network link " + String(ETH.linkUp() ? "up" : "down"));
+            due |= TimerWheel::bit(mdnsTimer) | TimerWheel::bit(ntpTimer);
+        }
+        
         // Handle mDNS
-        if (!MDNSManager::isInitialized()) {
-            MDNSManager::init();
-        } else {
-            MDNSManager::update();
+        if (due & TimerWheel::bit(mdnsTimer)) {
+            if (!MDNSManager::isInitialized()) {
+                MDNSManager::init();
+            } else {
+                MDNSManager::update();
+            }
         }
 
         // Initialize MQTT only after NTP sync
-        if (!mqttInitialized && ETH.linkUp()) {
+        if (!mqttInitialized) {
+            if (!(due & TimerWheel::bit(ntpTimer)) || !ETH.linkUp()) continue;
+            
             if (NtpManager::waitForSync(5000)) {
                 Logger::info("NTP synced - initializing MQTT");
                 mqttManager.begin();
@@ -81,72 +207,74 @@ void NetworkTask::taskFunction(void* parameter) {
                 Logger::info("MQTT Manager initialized");
             } else {
                 Logger::warning("Waiting for NTP sync before MQTT init");
-                vTaskDelay(pdMS_TO_TICKS(5000));
+                timers.start(ntpTimer, millis(), NTP_RETRY_INTERVAL);
                 continue;
             }
         }
         
         // Maintain MQTT connection
-        if (mqttInitialized) {
-            mqttManager.maintainConnection();
+        mqttManager.maintainConnection();
+        now = millis();
+        
+        // Handle regular publications when connected
+        if (mqttManager.isConnected()) {
+            // Readings taken while offline were never sent; the refresh and
+            // discovery metadata go out right away
+            if (!wasConnected) {
+                resetPublished();
+                wasConnected = true;
+                timers.stop(reconnectTimer);
+                timers.start(pollTimer, now, MQTT_POLL_INTERVAL);
+                timers.start(publishTimer, now, PUBLISH_INTERVAL);
+                timers.start(hadTimer, now, HAD_PUBLISH_INTERVAL);
+                due |= TimerWheel::bit(publishTimer) | TimerWheel::bit(hadTimer);
+            }
+            
+            // Relay changes, then the sensors of any new snapshot
+            drainPublishBuffer();
+            publishSnapshot(now, false);
             
-            // Handle regular publications when connected
-            if (mqttManager.isConnected()) {
-                uint32_t now = millis();
+            // Periodic refresh: resend what has gone quiet and the relays
+            if (due & TimerWheel::bit(publishTimer)) {
+                publishSnapshot(now, true);
                 
-                // Process any pending publish messages
-                TaskMessage msg;
-                while (xQueueReceive(publishQueue, &msg, 0) == pdTRUE) {
-                    if (msg.type == MessageType::SENSOR_DATA) {
-                        mqttManager.publishSensorData(msg.data.sensorData);
-                    } else if (msg.type == MessageType::RELAY_STATE) {
-                        mqttManager.publishRelayState(msg.data.relayState.id, 
-                                                    msg.data.relayState.state);
-                    }
+                mqttManager.startBatchPublish();
+                for (uint8_t i = 0; i < 2; i++) {
+                    bool state = ControlTask::getRelayState(i);
+                    mqttManager.publishRelayState(i, state);
                 }
+                mqttManager.endBatchPublish();
+            }
+            
+            // Periodic HAD metadata publication
+            if (due & TimerWheel::bit(hadTimer)) {
+                Logger::info("Publishing HAD metadata");
+                mqttManager.startBatchPublish();
                 
-                // Regular sensor data publication
-                if (now - lastPublishTime >= 30000) {
-                    mqttManager.startBatchPublish();
-                    
-                    // Publish all sensor data
-                    const auto& sensors = OneWireTask::getManager().getSensorList();
-                    for (const auto& sensor : sensors) {
-                        mqttManager.publishSensorData(sensor);
-                    }
-                    
-                    // Publish relay states
-                    for (uint8_t i = 0; i < 2; i++) {
-                        bool state = ControlTask::getRelayState(i);
-                        mqttManager.publishRelayState(i, state);
-                    }
-                    
-                    mqttManager.endBatchPublish();
-                    lastPublishTime = now;
+                // Publish metadata for all sensors
+                const auto sensors = SensorRegistry::getSensors();
+                for (const auto& sensor : sensors) {
+                    mqttManager.publishSensorMetadata(sensor);
                 }
                 
-                // Periodic HAD metadata publication
-                if (now - lastHADPublishTime >= hadPublishInterval) {
-                    Logger::info("Publishing HAD metadata");
-                    mqttManager.startBatchPublish();
-                    
-                    // Publish metadata for all sensors
-                    const auto& sensors = OneWireTask::getManager().getSensorList();
-                    for (const auto& sensor : sensors) {
-                        mqttManager.publishSensorMetadata(sensor);
-                    }
-                    
-                    // Publish relay metadata
-                    mqttManager.publishRelayMetadata();
-                    
-                    mqttManager.endBatchPublish();
-                    lastHADPublishTime = now;
-                    Logger::info("HAD metadata publication complete");
-                }
+                // Publish relay metadata
+                mqttManager.publishRelayMetadata();
+                
+                mqttManager.endBatchPublish();
+                Logger::info("HAD metadata publication complete");
+            }
+        } else {
+            if (wasConnected) {
+                wasConnected = false;
+                timers.stop(pollTimer);
+                timers.stop(publishTimer);
+                timers.stop(hadTimer);
+            }
+            
+            // Wake exactly when the backoff allows the next attempt
+            if (ETH.linkUp() && !timers.isArmed(reconnectTimer)) {
+                timers.start(reconnectTimer, now, std::max<uint32_t>(mqttManager.msUntilReconnect(), 1));
             }
         }
-
-        vTaskDelayUntil(&lastWakeTime, connectionCheckInterval);
     }
 }
-
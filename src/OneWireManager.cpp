@@ -5,18 +5,42 @@
 #include "Config.h"
 #include "OneWireManager.h"
 #include "Logger.h"
+#include "PreferencesManager.h"
+#ifdef ONEWIRE_SIMULATED_BUS
+#include "SimulatedOneWireBus.h"
+#else
+#include "ESP32OneWireBus.h"
+#endif
 #include <algorithm>
 
 // Constructor takes the OneWire bus pin and initializes the system
-OneWireManager::OneWireManager(uint8_t pin) 
-    : oneWire(pin)
-    , sensors(&oneWire)
+OneWireManager::OneWireManager(uint8_t pin, uint8_t busIndex)
+    : OneWireManager(createBus(pin), busIndex) {
+    Logger::info("OneWire bus " + String(busIndex) + " initialized on pin " + String(pin));
+}
+
+OneWireManager::OneWireManager(OneWireBus& bus, uint8_t busIndex) 
+    : oneWire(bus)
+    , table{}
+    , scanTable{}
     , busyFlag(false)
     , sensorMutex(nullptr)
     , lastScanTime(0)
     , lastReadTime(0)
     , conversionStartTime(0)
-    , conversionInProgress(false) {
+    , conversionInProgress(false)
+    , busIndex(busIndex)
+    , groups{}
+    , parasitePower(false)
+    , conversionPollable(false)
+    , discoveryActive(false)
+    , fullScanPending(false)
+    , discoverySeen(0)
+    , discoverySeenMask(0)
+    , scratchpad{}
+    , readResults{}
+    , lastCycleStats{}
+    , timing{} {
     
     // Create mutex for thread-safe access
     sensorMutex = xSemaphoreCreateMutex();
@@ -25,19 +49,28 @@ OneWireManager::OneWireManager(uint8_t pin)
         return;
     }
     
-    // Initialize hardware with proper configuration
-    pinMode(pin, INPUT_PULLUP);
-    vTaskDelay(pdMS_TO_TICKS(100));  // Allow bus to stabilize
-    sensors.begin();
-    
-    // Configure for efficient operation with multiple sensors
-    sensors.setWaitForConversion(false);  // Enable async operation
-    sensors.setResolution(12);  // Set precision to 12 bits (0.0625°C)
-    
-    Logger::info("OneWire bus initialized on pin " + String(pin));
+    // Resolution is configured per sensor when it is discovered
+    oneWire.begin();
+    parasitePower = readPowerSupply();
 }
 
-// Start a temperature conversion for all sensors simultaneously
+// Hardware bus on the given pin, or a bus of simulated DS18B20s when built
+// with ONEWIRE_SIMULATED_BUS. Managers live for the whole run, so the bus is
+// never freed.
+OneWireBus& OneWireManager::createBus(uint8_t pin) {
+#ifdef ONEWIRE_SIMULATED_BUS
+    SimulatedOneWireBus* bus = new SimulatedOneWireBus(pin);
+    bus->populate(ONEWIRE_SIMULATED_SENSORS);
+    return *bus;
+#else
+    return *new ESP32OneWireBus(pin);
+#endif
+}
+
+// Start a temperature conversion for all sensors simultaneously. Every device
+// finishes according to its own resolution, so each group is tracked separately.
+// With stagger slots only the first slot starts now; the others follow at even
+// offsets across the slowest conversion time.
 void OneWireManager::startTemperatureConversion() {
     if (!verifyMutex() || isBusBusy()) {
         Logger::warning("Cannot start conversion - bus busy or mutex invalid");
@@ -46,58 +79,459 @@ void OneWireManager::startTemperatureConversion() {
     
     setBusBusy(true);
     
-    // Request temperature conversion for all sensors at once
-    sensors.requestTemperatures();
+    if (STAGGER_SLOTS > 1 && !parasitePower) {
+        uint32_t now = millis();
+        uint32_t slowest = 0;
+        for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+            if (groups[g].members > 0) slowest = std::max(slowest, groupConversionTime(g));
+        }
+        uint32_t spacing = slowest / STAGGER_SLOTS;
+        
+        for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+            groups[g].inProgress = false;
+            groups[g].scheduled = false;
+            groups[g].due = false;
+            if (groups[g].members == 0) continue;
+            
+            uint8_t slot = g % STAGGER_SLOTS;
+            if (slot == 0) {
+                restartGroup(g, now);
+            } else {
+                groups[g].scheduled = true;
+                groups[g].scheduledStart = now + slot * spacing;
+            }
+        }
+        conversionStartTime = now;
+        conversionInProgress = activeGroupCount() > 0 || hasScheduledGroups();
+        conversionPollable = false;
+        
+        setBusBusy(false);
+        Logger::debug("Started staggered temperature conversion");
+        return;
+    }
+    
+    // Request temperature conversion for all sensors at once. Parasite-powered
+    // devices need the strong pull-up right after CONVERT T.
+    Transaction convert = beginTransaction();
+    if (timedReset()) {
+        oneWire.skip();
+        oneWire.write(CMD_CONVERT_T, parasitePower);
+        endTransaction(BusOperation::CONVERT, convert);
+    }
     conversionStartTime = millis();
-    conversionInProgress = true;
+    
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        groups[g].startTime = conversionStartTime;
+        groups[g].inProgress = groups[g].members > 0;
+        groups[g].scheduled = false;
+        groups[g].due = false;
+    }
+    conversionInProgress = activeGroupCount() > 0;
+    
+    // Externally powered devices answer read slots with 0 until they are done, but
+    // the bus only reports the slowest device. In parasite mode the bus is held high
+    // to power them, so only the clock counts.
+    conversionPollable = !parasitePower && activeGroupCount() == 1;
     
     setBusBusy(false);
     Logger::debug("Started temperature conversion for all sensors");
 }
 
-// Check if conversion is complete and collect temperatures if ready
+// Check whether any group has finished converting. The worst-case time for the
+// group's resolution is the upper bound; with a single group the busy bit is polled
+// from half-time on so results can be collected as soon as every device is done.
+bool OneWireManager::isConversionComplete() {
+    if (!conversionInProgress) return false;
+    
+    uint32_t now = millis();
+    startScheduledGroups(now);
+    markDueGroups(now);
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].due) return true;
+    }
+    
+    if (conversionPollable) {
+        for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+            if (!groups[g].inProgress) continue;
+            if (now - groups[g].startTime >= groupConversionTime(g) / 2 && 
+                oneWire.readBit() == 1) {
+                groups[g].due = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Time until isConversionComplete() is worth calling again
+uint32_t OneWireManager::msUntilConversionCheck() const {
+    if (!conversionInProgress) return 0;
+    
+    uint32_t now = millis();
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].scheduled) {
+            int32_t untilStart = (int32_t)(groups[g].scheduledStart - now);
+            if (untilStart <= 0) return 0;
+            wait = std::min(wait, (uint32_t)untilStart);
+        }
+        if (!groups[g].inProgress) continue;
+        if (groups[g].due) return 0;
+        
+        uint32_t elapsed = now - groups[g].startTime;
+        uint32_t required = groupConversionTime(g);
+        if (elapsed >= required) return 0;
+        
+        uint32_t remaining = required - elapsed;
+        if (conversionPollable) {
+            // Sleep through the first half, then poll the busy bit
+            remaining = (elapsed < required / 2) ? required / 2 - elapsed 
+                                                 : std::min(remaining, CONVERSION_POLL_INTERVAL);
+        }
+        wait = std::min(wait, remaining);
+    }
+    return wait == UINT32_MAX ? 0 : wait;
+}
+
+uint32_t OneWireManager::conversionTimeMs(uint8_t bits) {
+    if (bits < MIN_SENSOR_RESOLUTION) bits = MIN_SENSOR_RESOLUTION;
+    if (bits > MAX_SENSOR_RESOLUTION) bits = MAX_SENSOR_RESOLUTION;
+    // 93.75 ms at 9 bit, doubling per extra bit
+    return (750 >> (12 - bits)) + 1;
+}
+
+void OneWireManager::markDueGroups(uint32_t now) {
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].inProgress && now - groups[g].startTime >= groupConversionTime(g)) {
+            groups[g].due = true;
+        }
+    }
+}
+
+// Start the staggered groups whose offset has passed
+void OneWireManager::startScheduledGroups(uint32_t now) {
+    if (isBusBusy()) return;
+    
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].scheduled && (int32_t)(now - groups[g].scheduledStart) >= 0) {
+            setBusBusy(true);
+            restartGroup(g, now);
+            setBusBusy(false);
+        }
+    }
+}
+
+uint32_t OneWireManager::groupConversionTime(uint8_t group) const {
+    if (!parasitePower) {
+        return conversionTimeMs(MIN_SENSOR_RESOLUTION + group / STAGGER_SLOTS);
+    }
+    
+    // Parasite-powered devices share one broadcast and cannot be read early
+    uint8_t slowest = group / STAGGER_SLOTS;
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].members > 0) slowest = std::max<uint8_t>(slowest, g / STAGGER_SLOTS);
+    }
+    return conversionTimeMs(MIN_SENSOR_RESOLUTION + slowest);
+}
+
+uint8_t OneWireManager::activeGroupCount() const {
+    uint8_t active = 0;
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].inProgress) active++;
+    }
+    return active;
+}
+
+bool OneWireManager::hasScheduledGroups() const {
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].scheduled) return true;
+    }
+    return false;
+}
+
+// Stagger slots are assigned round-robin by table position
+uint8_t OneWireManager::sensorGroup(uint8_t index) const {
+    return groupIndex(table.resolution[index]) * STAGGER_SLOTS + index % STAGGER_SLOTS;
+}
+
+uint8_t OneWireManager::groupIndex(uint8_t resolution) {
+    if (resolution < MIN_SENSOR_RESOLUTION) resolution = MIN_SENSOR_RESOLUTION;
+    if (resolution > MAX_SENSOR_RESOLUTION) resolution = MAX_SENSOR_RESOLUTION;
+    return resolution - MIN_SENSOR_RESOLUTION;
+}
+
+void OneWireManager::rebuildGroups() {
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        groups[g].members = 0;
+    }
+    for (uint8_t i = 0; i < table.count; i++) {
+        groups[sensorGroup(i)].members++;
+    }
+}
+
+// Start another conversion for one group only, addressing each member directly
+void OneWireManager::restartGroup(uint8_t group, uint32_t now) {
+    for (uint8_t i = 0; i < table.count; i++) {
+        if (sensorGroup(i) != group) continue;
+        
+        Transaction convert = beginTransaction();
+        if (timedReset()) {
+            oneWire.select(table.address[i]);
+            oneWire.write(CMD_CONVERT_T);
+            endTransaction(BusOperation::CONVERT, convert);
+        }
+    }
+    groups[group].startTime = now;
+    groups[group].inProgress = true;
+    groups[group].due = false;
+    groups[group].scheduled = false;
+}
+
+// Collect the results of the last conversion in a single pass over the sensor table.
+// Each sensor costs one MATCH ROM + READ SCRATCHPAD into a preallocated buffer; the
+// mutex is only held afterwards to apply the results to the existing entries in place.
+// The table is only replaced by scanDevices() on this same task, so walking it
+// without the lock is safe here.
 bool OneWireManager::checkAndCollectTemperatures() {
     if (!verifyMutex() || !sensorMutex) return false;
     
+    conversionPollable = false;
+    markDueGroups(millis());
+    CycleStats stats = {};
+    const uint8_t count = table.count;
+    const uint32_t cycleStart = millis();
+    
+    uint32_t busStart = micros();
+    const uint32_t runTime = taskRunTime();
+    
+    // In alarm-search mode, armed sensors that stayed inside their band are
+    // left alone unless their reading is due for a refresh
+    uint32_t alarmMask = 0;
+    bool alarmFiltered = false;
+    if (ONEWIRE_ALARM_SEARCH) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (table.flags[i] & SensorTable::FLAG_ALARM_ARMED) {
+                alarmFiltered = alarmSearch(alarmMask);
+                break;
+            }
+        }
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        readResults[i].armed = false;
+        if (!groups[sensorGroup(i)].due) {
+            readResults[i].status = ReadStatus::SKIPPED;
+            continue;
+        }
+        
+        if (alarmFiltered && (table.flags[i] & SensorTable::FLAG_ALARM_ARMED) &&
+            table.isValid(i) && !(alarmMask & (1UL << i)) &&
+            cycleStart - table.lastReadTime[i] < ALARM_FULL_REFRESH_INTERVAL) {
+            readResults[i].status = ReadStatus::SKIPPED;
+            stats.inBand++;
+            continue;
+        }
+        
+        Transaction read = beginTransaction();
+        readResults[i].status = readScratchpad(table.address[i], readResults[i].raw, stats);
+        endTransaction(BusOperation::SCRATCHPAD, read);
+        
+        // A single corrupted transfer is usually noise; read once more right away
+        if (readResults[i].status == ReadStatus::CRC_ERROR) {
+            read = beginTransaction();
+            readResults[i].status = readScratchpad(table.address[i], readResults[i].raw, stats);
+            endTransaction(BusOperation::CRC_RETRY, read);
+        }
+        
+        // Only a band that moved costs a WRITE SCRATCHPAD
+        ReadResult& result = readResults[i];
+        if (ONEWIRE_ALARM_SEARCH && result.status == ReadStatus::OK) {
+            alarmBand(result.raw, result.th, result.tl);
+            result.armed = ((table.flags[i] & SensorTable::FLAG_ALARM_ARMED) &&
+                            table.alarmTh[i] == result.th && table.alarmTl[i] == result.tl) ||
+                           writeAlarmBand(table.address[i], result.th, result.tl, table.resolution[i]);
+        }
+    }
+    stats.busTimeUs = micros() - busStart;
+    timing.recordPass(runTime, taskRunTime());
+    
     if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
         Logger::error("Failed to acquire mutex in checkAndCollectTemperatures");
         return false;
     }
     
+    uint32_t lockStart = micros();
+    uint32_t now = millis();
     bool success = true;
-    std::vector<TemperatureSensor> updatedList;
-    updatedList.reserve(sensorList.size());
     
-    for (const auto& sensor : sensorList) {
-        TemperatureSensor updated = sensor;
-        float temp = sensors.getTempC(sensor.address);
+    for (uint8_t i = 0; i < count; i++) {
+        const ReadResult& result = readResults[i];
         
-        if (temp != DEVICE_DISCONNECTED_C && temp != 85.0) {
-            updated.temperature = temp;
-            updated.lastValidReading = temp;
-            updated.lastReadTime = millis();
-            updated.valid = true;
-            updated.consecutiveErrors = 0;
+        if (result.status == ReadStatus::SKIPPED) {
+            continue;
+        }
+        
+        table.readCount[i]++;
+        if (result.status == ReadStatus::OK) {
+            table.sample[i] = result.raw;
+            table.raw[i] = table.filter[i].update(result.raw);
+            table.lastValidRaw[i] = table.raw[i];
+            table.lastReadTime[i] = now;
+            table.flags[i] |= SensorTable::FLAG_VALID;
+            table.consecutiveErrors[i] = 0;
+            if (result.armed) {
+                table.flags[i] |= SensorTable::FLAG_ALARM_ARMED;
+                table.alarmTh[i] = result.th;
+                table.alarmTl[i] = result.tl;
+            } else {
+                table.flags[i] &= ~SensorTable::FLAG_ALARM_ARMED;
+            }
         } else {
-            updated.consecutiveErrors++;
-            if (updated.consecutiveErrors > MAX_RETRIES) {
-                updated.valid = false;
+            // A device that lost power reloads TH/TL from EEPROM
+            table.flags[i] &= ~SensorTable::FLAG_ALARM_ARMED;
+            table.errorCount[i]++;
+            if (table.consecutiveErrors[i] < UINT8_MAX) {
+                table.consecutiveErrors[i]++;
+            }
+            if (table.consecutiveErrors[i] > MAX_RETRIES) {
+                table.flags[i] &= ~SensorTable::FLAG_VALID;
             }
             // Keep last valid reading but mark as invalid
-            updated.temperature = updated.lastValidReading;
+            table.raw[i] = table.lastValidRaw[i];
             success = false;
         }
-        updatedList.push_back(std::move(updated));
     }
     
-    sensorList = std::move(updatedList);
-    conversionInProgress = false;
+    stats.lockTimeUs = micros() - lockStart;
+    lastCycleStats = stats;
     
     xSemaphoreGive(sensorMutex);
+    
+    // Groups that were read are idle again. While a slower group is still converting,
+    // restart every idle group that can finish before it does.
+    uint32_t cycleEnd = 0;
+    bool slowerRunning = false;
+    for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+        if (groups[g].due) {
+            groups[g].due = false;
+            groups[g].inProgress = false;
+        }
+        if (groups[g].inProgress) {
+            cycleEnd = std::max(cycleEnd, groups[g].startTime + groupConversionTime(g));
+            slowerRunning = true;
+        } else if (groups[g].scheduled) {
+            cycleEnd = std::max(cycleEnd, groups[g].scheduledStart + groupConversionTime(g));
+            slowerRunning = true;
+        }
+    }
+    
+    // With stagger slots this pipelines the bus: a slot that was just read
+    // converts again while later slots are still converting
+    if (slowerRunning && !parasitePower) {
+        uint32_t restartTime = millis();
+        for (uint8_t g = 0; g < GROUP_COUNT; g++) {
+            if (groups[g].members > 0 && !groups[g].inProgress && !groups[g].scheduled &&
+                (int32_t)(cycleEnd - (restartTime + groupConversionTime(g))) >= 0) {
+                restartGroup(g, restartTime);
+            }
+        }
+    }
+    
+    conversionInProgress = activeGroupCount() > 0 || hasScheduledGroups();
     return success;
 }
 
-// Enhanced bus scanning with better error handling and retry logic
+// Address one device and stream its scratchpad into the shared buffer, accumulating
+// the CRC while the bytes arrive. A device that dropped off the bus after the
+// presence pulse leaves every byte at 0xFF. A 0xFFFF temperature alone is a valid
+// -0.0625 C reading, but a DS18B20 configuration byte never reads 0xFF (bit 7 is
+// always 0), so the read stops there; the next reset ends it on the device. The
+// DS18S20 has 0xFF in bytes 4 and 5 and stops at COUNT_PER_C, always 0x10.
+OneWireManager::ReadStatus OneWireManager::readScratchpad(const uint8_t* address, 
+                                                          int16_t& raw, 
+                                                          CycleStats& stats) {
+    stats.resets++;
+    if (!timedReset()) {
+        return ReadStatus::NO_PRESENCE;
+    }
+    
+    oneWire.select(address);
+    oneWire.write(CMD_READ_SCRATCHPAD);
+    stats.bitSlots += (1 + 8 + 1) * 8;  // MATCH ROM, ROM code, function command
+    
+    const uint8_t lastFixed = address[0] == 0x10 ? SP_COUNT_PER_C : SP_CONFIG;
+    uint8_t crc = 0;
+    bool allZeros = true;
+    bool allOnes = true;
+    for (uint8_t i = 0; i < SCRATCHPAD_SIZE; i++) {
+        scratchpad[i] = oneWire.read();
+        stats.bitSlots += 8;
+        
+        if (i < SP_CRC) {
+            crc = crc8Update(crc, scratchpad[i]);
+        }
+        if (scratchpad[i] != 0x00) {
+            allZeros = false;
+        }
+        if (scratchpad[i] != 0xFF) {
+            allOnes = false;
+        }
+        
+        // A missing device leaves the bus pulled high
+        if (i == lastFixed && allOnes) {
+            return ReadStatus::NOT_RESPONDING;
+        }
+    }
+    
+    // A shorted bus reads all zeros, which carries a valid CRC
+    if (allZeros || crc != scratchpad[SP_CRC]) {
+        stats.crcErrors++;
+        return ReadStatus::CRC_ERROR;
+    }
+    
+    raw = scratchpadToRaw(address, scratchpad);
+    if (raw == RAW_POWER_ON_RESET) {
+        return ReadStatus::POWER_ON_RESET;
+    }
+    return ReadStatus::OK;
+}
+
+// Convert a validated scratchpad to 1/16 C, handling the DS18S20 format and the
+// undefined low bits of DS18B20 readings taken below 12-bit resolution
+int16_t OneWireManager::scratchpadToRaw(const uint8_t* address, const uint8_t* data) {
+    int16_t raw = (int16_t)(((uint16_t)data[SP_TEMP_MSB] << 8) | data[SP_TEMP_LSB]);
+    
+    if (address[0] == 0x10) {
+        // DS18S20: 0.5 C steps extended with COUNT_REMAIN / COUNT_PER_C
+        int16_t whole = (raw >> 1) * 16;
+        uint8_t perC = data[SP_COUNT_PER_C];
+        if (perC == 0) {
+            return whole;
+        }
+        return whole - 4 + ((perC - data[SP_COUNT_REMAIN]) * 16) / perC;
+    }
+    
+    switch ((data[SP_CONFIG] >> 5) & 0x03) {
+        case 0:  return raw & ~7;  // 9 bit
+        case 1:  return raw & ~3;  // 10 bit
+        case 2:  return raw & ~1;  // 11 bit
+        default: return raw;       // 12 bit
+    }
+}
+
+// Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1), one byte at a time
+uint8_t OneWireManager::crc8Update(uint8_t crc, uint8_t data) {
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        uint8_t mix = (crc ^ data) & 0x01;
+        crc >>= 1;
+        if (mix) crc ^= 0x8C;
+        data >>= 1;
+    }
+    return crc;
+}
+
+// Full search of the bus. Runs without delays so it only costs the bus time of
+// the search itself; it is requested by discoveryStep() when devices come or go.
 bool OneWireManager::scanDevices() {
     if (isBusBusy()) {
         Logger::warning("Cannot scan - bus is busy");
@@ -105,182 +539,404 @@ bool OneWireManager::scanDevices() {
     }
     
     setBusBusy(true);
-    std::vector<TemperatureSensor> tempList;
+    conversionPollable = false;
     bool scanSuccess = false;
     
-    try {
-        Logger::info("Starting OneWire bus scan...");
+    // Scans repeat while the bus runs, so their messages stay off the heap
+    Logger::logf(Logger::Level::INFO, Logger::Category::GENERAL, "Starting OneWire bus scan...");
+    
+    for (int retry = 0; retry < MAX_RETRIES && !scanSuccess; retry++) {
+        scanTable.clear();
+        scanSuccess = searchDevices(scanTable);
         
-        for (int retry = 0; retry < MAX_RETRIES; retry++) {
-            sensors.begin();  // Reset the bus
-            vTaskDelay(pdMS_TO_TICKS(100));
-            
-            uint8_t deviceCount = sensors.getDeviceCount();
-            if (deviceCount > 0) {
-                // Explicitly cast to avoid type issues with std::min
-                uint8_t maxCount = (deviceCount <= MAX_ONEWIRE_SENSORS) ? 
-                                   deviceCount : MAX_ONEWIRE_SENSORS;
-                Logger::info("Found " + String(maxCount) + " devices");
-                
-                scanSuccess = processFoundDevices(maxCount, tempList);
-                if (scanSuccess) break;
-            }
-            
-            Logger::warning("Scan attempt " + String(retry + 1) + " failed");
-            vTaskDelay(pdMS_TO_TICKS(500));
+        // An empty bus only replaces a populated list once it is confirmed
+        if (scanSuccess && scanTable.count == 0 && table.count > 0 && retry + 1 < MAX_RETRIES) {
+            scanSuccess = false;
+        }
+        if (!scanSuccess) {
+            Logger::logf(Logger::Level::WARNING, Logger::Category::GENERAL, 
+                         "Scan attempt %d failed", retry + 1);
+        }
+    }
+    
+    parasitePower = readPowerSupply();
+    
+    if (scanSuccess) {
+        Logger::logf(Logger::Level::INFO, Logger::Category::GENERAL, 
+                     "Found %u devices", scanTable.count);
+        updateSensorTable(scanTable);
+        lastScanTime = millis();
+    }
+    
+    // The incremental pass compares against the list just replaced
+    fullScanPending = !scanSuccess;
+    discoveryActive = false;
+    
+    setBusBusy(false);
+    return scanSuccess;
+}
+
+// Walk the whole ROM tree once. Returns false if the search hit a corrupted ROM.
+bool OneWireManager::searchDevices(SensorTable& found) {
+    uint8_t rom[8];
+    
+    oneWire.resetSearch();
+    while (timedSearch(rom)) {
+        if (OneWireBus::crc8(rom, 7) != rom[7]) {
+            Logger::warning("CRC error in ROM search: " + addressToString(rom));
+            return false;
         }
         
-        if (scanSuccess) {
-            updateSensorList(tempList);
-            lastScanTime = millis();
+        if (!isSupportedDevice(rom)) {
+            Logger::warning("Ignoring unsupported OneWire device: " + addressToString(rom));
+            continue;
         }
         
-    } catch (const std::exception& e) {
-        Logger::error("Exception during scan: " + String(e.what()));
-        scanSuccess = false;
+        if (found.count >= MAX_ONEWIRE_SENSORS) {
+            Logger::warning("Sensor limit reached, ignoring " + addressToString(rom));
+            continue;
+        }
+        
+        // Settings from older firmware must be in the table before they are read
+        PreferencesManager::sensorFound(rom);
+        
+        // DS18S20 has a fixed 9 bit register extended by COUNT_REMAIN and
+        // always takes the full 750 ms
+        int existing = findSensorIndex(rom);
+        uint8_t bits = (rom[0] == 0x10) ? MAX_SENSOR_RESOLUTION 
+                                        : PreferencesManager::getSensorResolution(rom);
+        if (existing < 0 || table.resolution[existing] != bits) {
+            bits = applyResolution(rom, bits);
+        }
+        
+        found.add(rom, bits, PreferencesManager::getSensorFilter(rom));
+        if (Logger::isEnabled(Logger::Level::DEBUG)) {
+            Logger::debug("Added sensor: " + addressToString(rom));
+        }
     }
     
+    return true;
+}
+
+// Start a presence/diff pass over the bus
+void OneWireManager::startDiscoveryPass() {
+    oneWire.resetSearch();
+    discoverySeen = 0;
+    discoverySeenMask = 0;
+    discoveryActive = true;
+}
+
+// Find the next ROM on the bus. The pass ends early at the first unknown ROM
+// and, when it runs to completion, compares the number of known ROMs seen with
+// the sensor list. Either difference schedules a full scan. Returns true while
+// the pass has more work to do.
+bool OneWireManager::discoveryStep() {
+    if (!discoveryActive) return false;
+    
+    // Parasite-powered devices draw their conversion current from the bus
+    if (isBusBusy() || (conversionInProgress && parasitePower)) return true;
+    
+    setBusBusy(true);
+    conversionPollable = false;
+    uint8_t rom[8];
+    bool found = timedSearch(rom);
     setBusBusy(false);
-    return scanSuccess;
+    
+    if (!found) {
+        discoveryActive = false;
+        if (discoverySeen != table.count) {
+            Logger::info("Device missing from OneWire bus " + String(busIndex) + 
+                        " - full scan scheduled");
+            fullScanPending = true;
+        }
+        return false;
+    }
+    
+    if (OneWireBus::crc8(rom, 7) != rom[7]) {
+        // Noise on the bus; try again with the next pass
+        discoveryActive = false;
+        return false;
+    }
+    
+    if (!isSupportedDevice(rom)) return true;
+    
+    int index = findSensorIndex(rom);
+    if (index < 0) {
+        if (table.count >= MAX_ONEWIRE_SENSORS) return true;
+        
+        Logger::info("New device " + addressToString(rom) + " on OneWire bus " + 
+                    String(busIndex) + " - full scan scheduled");
+        fullScanPending = true;
+        discoveryActive = false;
+        return false;
+    }
+    
+    if (!(discoverySeenMask & (1UL << index))) {
+        discoverySeenMask |= (1UL << index);
+        discoverySeen++;
+    }
+    return true;
 }
 
-// Helper method to process devices found during scan
-bool OneWireManager::processFoundDevices(uint8_t deviceCount, 
-                                       std::vector<TemperatureSensor>& tempList) {
-    bool anyDeviceProcessed = false;
-    uint8_t processedCount = 0;
-    
-    // Add explicit bounds checking - use manual comparison to avoid type issues
-    uint8_t maxDevicesToProcess = deviceCount;
-    if (maxDevicesToProcess > MAX_ONEWIRE_SENSORS) {
-        maxDevicesToProcess = MAX_ONEWIRE_SENSORS;
-    }
-    
-    for (uint8_t i = 0; i < maxDevicesToProcess && processedCount < MAX_ONEWIRE_SENSORS; i++) {
-        DeviceAddress tempAddr;
-        if (sensors.getAddress(tempAddr, i)) {
-            // Add ROM validation check - first byte should be family code (typically 0x28 for DS18B20)
-            if (tempAddr[0] != 0x28 && tempAddr[0] != 0x10) {
-                String addrStr = "";
-                for (uint8_t j = 0; j < 8; j++) {
-                    addrStr += String(tempAddr[j], HEX);
-                    if (j < 7) addrStr += ":";
-                }
-                Logger::warning("Invalid family code in OneWire device: " + 
-                              String(tempAddr[0], HEX) + " full address: " + addrStr);
-                continue;
-            }
-            
-            // Check for all zeros or all ones (invalid addresses)
-            bool allZeros = true;
-            bool allOnes = true;
-            for (uint8_t j = 0; j < 8; j++) {
-                if (tempAddr[j] != 0x00) allZeros = false;
-                if (tempAddr[j] != 0xFF) allOnes = false;
-            }
-            
-            if (allZeros || allOnes) {
-                Logger::warning("Invalid OneWire address (all zeros or all ones)");
-                continue;
-            }
-            
-            TemperatureSensor sensor = {};
-            sensor.isActive = true;
-            memcpy(sensor.address, tempAddr, sizeof(DeviceAddress));
-            
-            // Initialize sensor state
-            sensor.valid = false;
-            sensor.consecutiveErrors = 0;
-            sensor.temperature = DEVICE_DISCONNECTED_C;
-            sensor.lastValidReading = DEVICE_DISCONNECTED_C;
-            sensor.lastReadTime = 0;
-            
-            if (sensors.validAddress(sensor.address)) {
-                tempList.push_back(std::move(sensor));
-                anyDeviceProcessed = true;
-                Logger::debug("Added sensor: " + addressToString(tempAddr));
-                processedCount++;
-            }
+int OneWireManager::findSensorIndex(const uint8_t* address) const {
+    return sensorIndex.find(RomIndex<MAX_ONEWIRE_SENSORS>::toKey(address));
+}
+
+void OneWireManager::rebuildSensorIndex() {
+    sensorIndex.clear();
+    for (uint8_t i = 0; i < table.count; i++) {
+        sensorIndex.insert(RomIndex<MAX_ONEWIRE_SENSORS>::toKey(table.address[i]), i);
+    }
+}
+
+OneWireManager::Transaction OneWireManager::beginTransaction() const {
+    Transaction transaction;
+    transaction.startUs = micros();
+    return transaction;
+}
+
+void OneWireManager::endTransaction(BusOperation op, const Transaction& transaction) {
+    timing.record(op, micros() - transaction.startUs);
+}
+
+// The task's FreeRTOS run-time counter only advances when the task is switched
+// out. Bus transactions busy-wait and never block, so a change across the bus
+// part of a collection pass means another task ran on this core meanwhile.
+// vTaskGetInfo walks the task lists, so it is read twice per pass, not per
+// transaction. Stays 0 when the framework was built without run-time stats.
+uint32_t OneWireManager::taskRunTime() {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    TaskStatus_t status;
+    vTaskGetInfo(nullptr, &status, pdFALSE, eRunning);
+    return status.ulRunTimeCounter;
+#else
+    return 0;
+#endif
+}
+
+bool OneWireManager::timedReset() {
+    Transaction reset = beginTransaction();
+    bool present = oneWire.reset();
+    endTransaction(BusOperation::RESET, reset);
+    return present;
+}
+
+bool OneWireManager::timedSearch(uint8_t* rom, bool alarmOnly) {
+    Transaction search = beginTransaction();
+    bool found = oneWire.search(rom, alarmOnly);
+    if (found) {
+        endTransaction(alarmOnly ? BusOperation::ALARM_SEARCH : BusOperation::SEARCH, search);
+    }
+    return found;
+}
+
+// ALARM SEARCH after a conversion: collect the table positions of the devices
+// whose alarm flag is set. Fails on a corrupted ROM so the caller reads everything.
+bool OneWireManager::alarmSearch(uint32_t& alarmMask) {
+    alarmMask = 0;
+    uint8_t rom[8];
+    
+    oneWire.resetSearch();
+    while (timedSearch(rom, true)) {
+        if (OneWireBus::crc8(rom, 7) != rom[7]) {
+            Logger::warning("CRC error in alarm search on bus " + String(busIndex));
+            return false;
+        }
+        int index = findSensorIndex(rom);
+        if (index >= 0) {
+            alarmMask |= 1UL << index;
         }
     }
+    return true;
+}
+
+// TH/TL one band either side of the whole-degree part of the reading. The
+// device compares only the integer temperature bits, so it flags itself once
+// that part moves by the band.
+void OneWireManager::alarmBand(int16_t raw, int8_t& th, int8_t& tl) {
+    int16_t whole = raw >> 4;
+    th = (int8_t)constrain(whole + ALARM_BAND_DEGREES, -55, 125);
+    tl = (int8_t)constrain(whole - ALARM_BAND_DEGREES, -55, 125);
+}
+
+// Written to the scratchpad only, not to EEPROM
+bool OneWireManager::writeAlarmBand(const uint8_t* address, int8_t th, int8_t tl, uint8_t resolution) {
+    if (!timedReset()) return false;
+    oneWire.select(address);
+    oneWire.write(CMD_WRITE_SCRATCHPAD);
+    oneWire.write((uint8_t)th);
+    oneWire.write((uint8_t)tl);
+    if (address[0] == 0x28) {
+        // DS18B20 takes the configuration register in the same write
+        oneWire.write((uint8_t)(((resolution - MIN_SENSOR_RESOLUTION) << 5) | 0x1F));
+    }
+    return true;
+}
+
+// DS18B20 (0x28) and DS18S20 (0x10) only
+bool OneWireManager::isSupportedDevice(const uint8_t* rom) {
+    return rom[0] == 0x28 || rom[0] == 0x10;
+}
+
+// READ POWER SUPPLY: parasite-powered devices pull the read slot low
+bool OneWireManager::readPowerSupply() {
+    if (!timedReset()) return false;
+    oneWire.skip();
+    oneWire.write(CMD_READ_POWER_SUPPLY);
+    return oneWire.readBit() == 0;
+}
+
+// Program a sensor's configuration register. The register is copied to EEPROM,
+// so it is only written when the device disagrees with the requested setting.
+// Returns the resolution the device ends up with.
+uint8_t OneWireManager::applyResolution(const uint8_t* address, uint8_t bits) {
+    if (address[0] == 0x10) {
+        return MAX_SENSOR_RESOLUTION;
+    }
+    
+    CycleStats stats = {};
+    int16_t raw;
+    ReadStatus status = readScratchpad(address, raw, stats);
+    if (status != ReadStatus::OK && status != ReadStatus::POWER_ON_RESET) {
+        Logger::warning("Failed to read configuration of sensor " + addressToString(address));
+        return MAX_SENSOR_RESOLUTION;
+    }
+    
+    uint8_t current = MIN_SENSOR_RESOLUTION + ((scratchpad[SP_CONFIG] >> 5) & 0x03);
+    if (current == bits) {
+        return bits;
+    }
     
-    return anyDeviceProcessed;
+    // Write TH/TL back unchanged together with the new configuration
+    uint8_t th = scratchpad[SP_TH];
+    uint8_t tl = scratchpad[SP_TL];
+    bool written = false;
+    if (timedReset()) {
+        oneWire.select(address);
+        oneWire.write(CMD_WRITE_SCRATCHPAD);
+        oneWire.write(th);
+        oneWire.write(tl);
+        oneWire.write((uint8_t)(((bits - MIN_SENSOR_RESOLUTION) << 5) | 0x1F));
+        
+        if (timedReset()) {
+            oneWire.select(address);
+            oneWire.write(CMD_COPY_SCRATCHPAD, parasitePower);
+            vTaskDelay(pdMS_TO_TICKS(EEPROM_WRITE_MS));
+            written = true;
+        }
+    }
+    
+    status = readScratchpad(address, raw, stats);
+    if (!written || (status != ReadStatus::OK && status != ReadStatus::POWER_ON_RESET) ||
+        MIN_SENSOR_RESOLUTION + ((scratchpad[SP_CONFIG] >> 5) & 0x03) != bits) {
+        Logger::warning("Failed to set resolution for sensor " + addressToString(address));
+        return current;
+    }
+    
+    Logger::info("Sensor " + addressToString(address) + " set to " + String(bits) + " bit");
+    return bits;
 }
 
-// Update sensor list with thread safety and data preservation
-void OneWireManager::updateSensorList(const std::vector<TemperatureSensor>& newList) {
+// Re-apply stored resolutions and filters to all known sensors. Must not run
+// while a conversion is in progress, since the group schedule depends on them.
+// A sensor whose filter type changed starts that filter from scratch.
+void OneWireManager::reloadSensorConfig() {
+    if (!verifyMutex() || isBusBusy() || conversionInProgress) {
+        Logger::warning("Cannot reload sensor config - bus busy");
+        return;
+    }
+    
+    setBusBusy(true);
+    
+    // The table is only replaced on this task, so it can be walked without the mutex
+    uint8_t applied[MAX_ONEWIRE_SENSORS];
+    FilterType filters[MAX_ONEWIRE_SENSORS];
+    const uint8_t count = table.count;
+    for (uint8_t i = 0; i < count; i++) {
+        applied[i] = applyResolution(table.address[i], 
+                                     PreferencesManager::getSensorResolution(table.address[i]));
+        filters[i] = PreferencesManager::getSensorFilter(table.address[i]);
+    }
+    
+    if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (uint8_t i = 0; i < count; i++) {
+            table.resolution[i] = applied[i];
+            table.filter[i].configure(filters[i]);
+        }
+        rebuildGroups();
+        xSemaphoreGive(sensorMutex);
+    } else {
+        Logger::error("Failed to acquire mutex in reloadSensorConfig");
+    }
+    
+    setBusBusy(false);
+}
+
+// Replace the table with the result of a scan, carrying over the reading
+// history of sensors that were already known
+void OneWireManager::updateSensorTable(SensorTable& found) {
     if (!verifyMutex()) return;
     
     if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        try {
-            std::vector<TemperatureSensor> updatedList;
-            updatedList.reserve(newList.size());
+        for (uint8_t i = 0; i < found.count; i++) {
+            int existing = findSensorIndex(found.address[i]);
+            if (existing < 0) continue;
             
-            // Preserve existing sensor data while updating the list
-            for (const auto& newSensor : newList) {
-                bool found = false;
-                
-                // Look for matching sensor in existing list
-                for (const auto& existingSensor : sensorList) {
-                    if (memcmp(existingSensor.address, newSensor.address, 8) == 0) {
-                        // Preserve historical data for existing sensors
-                        TemperatureSensor updated = newSensor;
-                        if (existingSensor.valid) {
-                            updated.temperature = existingSensor.temperature;
-                            updated.lastValidReading = existingSensor.lastValidReading;
-                            updated.lastReadTime = existingSensor.lastReadTime;
-                            updated.valid = existingSensor.valid;
-                            updated.consecutiveErrors = existingSensor.consecutiveErrors;
-                        }
-                        updatedList.push_back(updated);
-                        found = true;
-                        break;
-                    }
-                }
-                
-                // Add new sensors with initialized state
-                if (!found) {
-                    updatedList.push_back(newSensor);
-                }
+            found.copyCounters(i, table, existing);
+            if (table.isValid(existing)) {
+                found.copyState(i, table, existing);
             }
-            
-            // Update the main sensor list
-            sensorList = std::move(updatedList);
-            Logger::info("Updated sensor list with " + String(sensorList.size()) + 
-                        " sensors");
-            
-        } catch (const std::exception& e) {
-            Logger::error("Exception during sensor list update: " + String(e.what()));
         }
         
+        table = found;
+        rebuildSensorIndex();
+        rebuildGroups();
+        Logger::logf(Logger::Level::INFO, Logger::Category::GENERAL, 
+                     "Updated sensor list with %u sensors", table.count);
+        
         xSemaphoreGive(sensorMutex);
     } else {
-        Logger::error("Failed to acquire mutex in updateSensorList");
+        Logger::error("Failed to acquire mutex in updateSensorTable");
     }
 }
 
-// Thread-safe access to the sensor list
-const std::vector<TemperatureSensor>& OneWireManager::getSensorList() const {
-    static const std::vector<TemperatureSensor> emptyList;
+// Sensors keep the resolution they were last programmed with, so it is trusted
+// here as well; the discovery pass that follows schedules a full scan on any
+// difference with the bus.
+bool OneWireManager::loadKnownDevices(const KnownDeviceCache& cache) {
+    if (!verifyMutex() || cache.count == 0) return false;
     
-    if (!verifyMutex() || !sensorMutex) {
-        Logger::error("Invalid mutex in getSensorList");
-        return emptyList;
+    scanTable.clear();
+    for (uint8_t i = 0; i < cache.count; i++) {
+        const KnownDeviceCache::Entry& entry = cache.entries[i];
+        if (!isSupportedDevice(entry.rom) || OneWireBus::crc8(entry.rom, 7) != entry.rom[7]) {
+            continue;
+        }
+        uint8_t bits = constrain(entry.resolution, MIN_SENSOR_RESOLUTION, MAX_SENSOR_RESOLUTION);
+        scanTable.add(entry.rom, bits, static_cast<FilterType>(entry.filter));
     }
+    if (scanTable.count == 0) return false;
     
-    if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
-        Logger::error("Failed to acquire mutex in getSensorList");
-        return emptyList;
+    updateSensorTable(scanTable);
+    Logger::info("Restored " + String(table.count) + " known sensors on bus " + String(busIndex));
+    return true;
+}
+
+void OneWireManager::exportKnownDevices(KnownDeviceCache& cache) const {
+    memset(&cache, 0, sizeof(cache));
+    cache.version = KnownDeviceCache::VERSION;
+    cache.count = table.count;
+    for (uint8_t i = 0; i < table.count; i++) {
+        memcpy(cache.entries[i].rom, table.address[i], 8);
+        cache.entries[i].resolution = table.resolution[i];
+        cache.entries[i].filter = static_cast<uint8_t>(table.filter[i].getType());
     }
-    
-    const auto& list = sensorList;  
-    xSemaphoreGive(sensorMutex);
-    return list;
 }
 
-// Check if enough time has passed for a new scan
-bool OneWireManager::shouldScan() const {
-    return (millis() - lastScanTime) >= SCAN_INTERVAL;
+// The bus's own sensor table. Only the task that owns this bus may use it; it
+// changes on every collection pass. Other tasks read SensorRegistry snapshots.
+const SensorTable& OneWireManager::getSensorTable() const {
+    return table;
 }
 
 bool OneWireManager::shouldRead() const {
@@ -315,7 +971,8 @@ void OneWireManager::setBusBusy(bool busy) {
     if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
         busyFlag = busy;
         xSemaphoreGive(sensorMutex);
-        Logger::debug("Bus busy state changed to: " + String(busy));
+        Logger::logf(Logger::Level::DEBUG, Logger::Category::GENERAL, 
+                     "Bus busy state changed to: %d", busy);
     } else {
         Logger::error("Failed to acquire mutex in setBusBusy");
     }
@@ -344,50 +1001,4 @@ String OneWireManager::addressToString(const uint8_t* address) const {
              address[0], address[1], address[2], address[3],
              address[4], address[5], address[6], address[7]);
     return String(buffer);
-}
-
-float OneWireManager::getCachedTemperature(const uint8_t* address) {
-    if (!verifyMutex() || !sensorMutex) {
-        Logger::error("Invalid mutex in getCachedTemperature");
-        return DEVICE_DISCONNECTED_C;
-    }
-    
-    float temp = DEVICE_DISCONNECTED_C;
-    if (xSemaphoreTake(sensorMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        // Log the address we're looking for
-        String searchAddr = addressToString(address);
-        Logger::debug("Searching for babel temperature for sensor: " + searchAddr);
-        
-        // Log all available sensors for debugging
-        Logger::debug("Current sensor list:");
-        for (const auto& sensor : sensorList) {
-            String sensorAddr = addressToString(sensor.address);
-            Logger::debug(" - " + sensorAddr + ": " + String(sensor.temperature, 2) + 
-                         " (valid: " + String(sensor.valid) + ")");
-        }
-        
-        for (const auto& sensor : sensorList) {
-            if (memcmp(sensor.address, address, 8) == 0) {
-                // Return last valid reading if recent, otherwise return current temp
-                if (!sensor.valid && (millis() - sensor.lastReadTime) < 60000) {
-                    temp = sensor.lastValidReading;
-                    Logger::debug("Found sensor, using last valid reading: " + String(temp, 2));
-                } else {
-                    temp = sensor.temperature;
-                    Logger::debug("Found sensor, using current temperature: " + String(temp, 2));
-                }
-                break;
-            }
-        }
-        
-        if (temp == DEVICE_DISCONNECTED_C) {
-            Logger::debug("Sensor not found in list");
-        }
-        
-        xSemaphoreGive(sensorMutex);
-    } else {
-        Logger::error("Failed to acquire mutex in getCachedTemperature");
-    }
-    
-    return temp;
 }
\ No newline at end of file
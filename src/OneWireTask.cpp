@@ -3,121 +3,212 @@
 #include "esp_task_wdt.h"
 #include "NetworkTask.h"
 #include "ControlTask.h"
+#include "SensorRegistry.h"
+#include "PreferencesManager.h"
+#include "SystemHealth.h"
+#include <algorithm>
 
 // Static member initialization
-OneWireManager OneWireTask::manager(ONE_WIRE_BUS);
-QueueHandle_t OneWireTask::commandQueue = nullptr;
+OneWireManager* OneWireTask::managers[ONE_WIRE_BUS_COUNT] = {};
+QueueHandle_t OneWireTask::commandQueues[ONE_WIRE_BUS_COUNT] = {};
 SemaphoreHandle_t OneWireTask::dataMutex = nullptr;
+bool OneWireTask::configReloadPending[ONE_WIRE_BUS_COUNT] = {};
+KnownDeviceCache OneWireTask::knownDevices[ONE_WIRE_BUS_COUNT] = {};
+TimerWheel OneWireTask::timers[ONE_WIRE_BUS_COUNT];
 
 void OneWireTask::init() {
-    Logger::info("Initializing OneWire task");
+    Logger::info("Initializing OneWire task for " + String(ONE_WIRE_BUS_COUNT) + " bus(es)");
     
     // Initialize watchdog
     ESP_ERROR_CHECK(esp_task_wdt_init(CONFIG_ESP_TASK_WDT_TIMEOUT_S, true));
     ESP_ERROR_CHECK(esp_task_wdt_add(NULL));
     
-    // Create command queue and mutex
-    commandQueue = xQueueCreate(10, sizeof(TaskMessage));
-    dataMutex = xSemaphoreCreateMutex();
+    SensorRegistry::init();
     
-    if (!commandQueue || !dataMutex) {
-        Logger::error("Failed to create OneWire task queues or mutex");
+    dataMutex = xSemaphoreCreateMutex();
+    if (!dataMutex) {
+        Logger::error("Failed to create OneWire task mutex");
         return;
     }
     
+    // Create a manager and command queue for each bus
+    for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+        commandQueues[bus] = xQueueCreate(10, sizeof(TaskMessage));
+        if (!commandQueues[bus]) {
+            Logger::error("Failed to create OneWire command queue for bus " + String(bus));
+            return;
+        }
+        managers[bus] = new OneWireManager(ONE_WIRE_BUS_PINS[bus], bus);
+    }
+    
     Logger::info("OneWire task initialized successfully");
 }
 
 void OneWireTask::start() {
-    Logger::info("Starting OneWire task");
+    Logger::info("Starting OneWire tasks");
     
-    xTaskCreate(
-        taskFunction,
-        "OneWireTask",
-        ONEWIRE_TASK_STACK_SIZE,
-        nullptr,
-        ONEWIRE_TASK_PRIORITY,
-        nullptr
-    );
+    for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+        if (!managers[bus] || !commandQueues[bus]) continue;
+        
+        char taskName[16];
+        snprintf(taskName, sizeof(taskName), "OneWireTask%u", bus);
+        
+        xTaskCreatePinnedToCore(
+            taskFunction,
+            taskName,
+            ONEWIRE_TASK_STACK_SIZE,
+            reinterpret_cast<void*>(static_cast<uintptr_t>(bus)),
+            ONEWIRE_TASK_PRIORITY,
+            nullptr,
+            ONE_WIRE_BUS_CORES[bus]
+        );
+    }
 }
 
 void OneWireTask::taskFunction(void* parameter) {
-    TickType_t lastWakeTime = xTaskGetTickCount();
-    uint32_t lastScanTime = 0;
-    uint32_t lastReadTime = 0;
-    bool conversionStarted = false;
+    const uint8_t bus = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(parameter));
+    OneWireManager& manager = *managers[bus];
+    TimerWheel& wheel = timers[bus];
+    const uint8_t readTimer = wheel.add("read", READ_INTERVAL);
+    const uint8_t discoveryTimer = wheel.add("discovery", DISCOVERY_INTERVAL, 500);
+    bool readPending = false;
+    bool discoveryPending = false;
     
-    // Initial scan
-    Logger::info("Performing initial OneWire bus scan");
-    if (manager.scanDevices()) {
-        lastScanTime = millis();
-        Logger::info("Initial scan completed successfully");
+    // Trust the devices of the last run so the first conversion starts right
+    // away; a discovery pass checks them against the bus in the background
+    if (restoreKnownDevices(bus)) {
+        manager.startTemperatureConversion();
+        manager.startDiscoveryPass();
+        uint32_t now = millis();
+        wheel.start(readTimer, now, READ_INTERVAL);
+        wheel.start(discoveryTimer, now, DISCOVERY_INTERVAL);
+    } else {
+        Logger::info("Performing initial scan of OneWire bus " + String(bus));
+        bool scanned = manager.scanDevices();
+        if (scanned) {
+            publishSensors(bus);
+            saveKnownDevices(bus);
+            Logger::info("Initial scan completed successfully");
+        }
+        uint32_t now = millis();
+        wheel.start(readTimer, now, 0);
+        wheel.start(discoveryTimer, now, scanned ? DISCOVERY_INTERVAL : 0);
     }
     
     while (true) {
         esp_task_wdt_reset();
         
-        // Process commands
-        TaskMessage msg;
-        while (xQueueReceive(commandQueue, &msg, 0) == pdTRUE) {
-            processCommand(msg);
-        }
+        // Duties that cannot start right away stay pending until they can
+        uint32_t due = wheel.runDue(millis());
+        readPending |= (due & TimerWheel::bit(readTimer)) != 0;
+        discoveryPending |= (due & TimerWheel::bit(discoveryTimer)) != 0;
         
-        uint32_t currentTime = millis();
+        // Presence check: one ROM per iteration, interleaved with conversions
+        if (discoveryPending && !manager.isDiscoveryPassActive()) {
+            manager.startDiscoveryPass();
+            discoveryPending = false;
+        }
+        if (manager.isDiscoveryPassActive()) {
+            manager.discoveryStep();
+        }
         
-        // Periodic scan
-        if (currentTime - lastScanTime >= SCAN_INTERVAL) {
-            if (!manager.isBusBusy() && !conversionStarted) {
-                if (manager.scanDevices()) {
-                    lastScanTime = currentTime;
-                }
+        // Full scan only when the devices on the bus changed
+        if (manager.isFullScanPending() && 
+            !manager.isBusBusy() && !manager.isConversionInProgress()) {
+            if (manager.scanDevices()) {
+                publishSensors(bus);
+                saveKnownDevices(bus);
             }
         }
         
         // Temperature reading state machine
-        if (!conversionStarted) {
-            if (currentTime - lastReadTime >= READ_INTERVAL) {
-                if (!manager.isBusBusy()) {
-                    manager.startTemperatureConversion();
-                    conversionStarted = true;
-                }
-            }
-        } else {
-            if (manager.checkAndCollectTemperatures()) {
-                lastReadTime = currentTime;
-                conversionStarted = false;
-                
-                // Trigger publication of new temperature data
-                const auto& sensors = manager.getSensorList();
-                for (const auto& sensor : sensors) {
-                    if (sensor.valid) {
-                        TaskMessage pubMsg;
-                        pubMsg.type = MessageType::SENSOR_DATA;
-                        pubMsg.data.sensorData = sensor;  // Updated field name
-                        
-                        NetworkTask::enqueuePublication(pubMsg);
-                    }
-                }
+        if (!manager.isConversionInProgress()) {
+            if (readPending && !manager.isBusBusy()) {
+                manager.startTemperatureConversion();
+                readPending = false;
             }
+        } else if (manager.isConversionComplete()) {
+            manager.checkAndCollectTemperatures();
+            publishSensors(bus);
+            SystemHealth::updateBusTiming(bus, manager.getTiming(), manager.getLastCycleStats());
+        }
+        
+        // Resolution changes wait until no group is converting
+        if (configReloadPending[bus] && !manager.isConversionInProgress() && !manager.isBusBusy()) {
+            manager.reloadSensorConfig();
+            configReloadPending[bus] = false;
+            publishSensors(bus);
+            saveKnownDevices(bus);
+        }
+        
+        // Sleep until the next timer or conversion check; poll at TASK_INTERVAL
+        // only while a discovery pass or deferred work is in progress. Commands
+        // wake the task immediately.
+        uint32_t waitMs = wheel.msUntilNext(millis(), IDLE_WAIT);
+        if (manager.isDiscoveryPassActive() || manager.isFullScanPending() ||
+            readPending || configReloadPending[bus]) {
+            waitMs = std::min(waitMs, TASK_INTERVAL);
+        }
+        if (manager.isConversionInProgress()) {
+            waitMs = std::min(waitMs, manager.msUntilConversionCheck());
         }
         
-        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(TASK_INTERVAL));
+        TaskMessage msg;
+        if (xQueueReceive(commandQueues[bus], &msg, pdMS_TO_TICKS(waitMs)) == pdTRUE) {
+            processCommand(bus, msg);
+            while (xQueueReceive(commandQueues[bus], &msg, 0) == pdTRUE) {
+                processCommand(bus, msg);
+            }
+        }
+    }
+}
+
+// Hand the bus's current sensor state to the shared registry. The table is
+// only modified by this task, so it can be copied without the manager's mutex.
+void OneWireTask::publishSensors(uint8_t bus, const KnownDeviceCache* known) {
+    SensorRegistry::update(bus, managers[bus]->getSensorTable(), known);
+    NetworkTask::notify(NetworkTask::EVENT_SNAPSHOT);
+}
+
+bool OneWireTask::restoreKnownDevices(uint8_t bus) {
+    KnownDeviceCache& cache = knownDevices[bus];
+    if (!PreferencesManager::getKnownDevices(bus, cache) ||
+        !managers[bus]->loadKnownDevices(cache)) {
+        return false;
     }
+    publishSensors(bus, &cache);
+    return true;
 }
 
-void OneWireTask::processCommand(const TaskMessage& msg) {
+// Persist the current device list with names for the next boot
+void OneWireTask::saveKnownDevices(uint8_t bus) {
+    KnownDeviceCache& cache = knownDevices[bus];
+    managers[bus]->exportKnownDevices(cache);
+    for (uint8_t i = 0; i < cache.count; i++) {
+        String name = SensorRegistry::getSensorName(cache.entries[i].rom);
+        strlcpy(cache.entries[i].name, name.c_str(), sizeof(cache.entries[i].name));
+    }
+    PreferencesManager::setKnownDevices(bus, cache);
+}
+
+void OneWireTask::processCommand(uint8_t bus, const TaskMessage& msg) {
+    OneWireManager& manager = *managers[bus];
+    
     switch (msg.type) {
         case MessageType::SENSOR_SCAN_REQUEST:
-            Logger::info("Processing scan request");
-            if (!manager.isBusBusy()) {
-                manager.scanDevices();
+            Logger::info("Processing scan request on bus " + String(bus));
+            if (!manager.isBusBusy() && !manager.isConversionInProgress()) {
+                if (manager.scanDevices()) {
+                    publishSensors(bus);
+                    saveKnownDevices(bus);
+                }
             } else {
                 Logger::warning("Scan request ignored - bus busy");
             }
             break;
             
         case MessageType::TEMPERATURE_READ_REQUEST:
-            Logger::info("Processing temperature read request");
+            Logger::info("Processing temperature read request on bus " + String(bus));
             if (!manager.isBusBusy() && !manager.isConversionInProgress()) {
                 manager.startTemperatureConversion();
             } else {
@@ -125,6 +216,11 @@ void OneWireTask::processCommand(const TaskMessage& msg) {
             }
             break;
             
+        case MessageType::SENSOR_CONFIG_CHANGED:
+            Logger::info("Sensor configuration changed - reloading bus " + String(bus));
+            configReloadPending[bus] = true;
+            break;
+            
         default:
             Logger::warning("Unknown command received");
             break;
@@ -132,11 +228,17 @@ void OneWireTask::processCommand(const TaskMessage& msg) {
 }
 
 void OneWireTask::sendCommand(const TaskMessage& msg) {
-    if (commandQueue) {
-        if (xQueueSend(commandQueue, &msg, pdMS_TO_TICKS(100)) != pdPASS) {
-            Logger::error("Failed to send command to OneWire task");
+    for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+        sendCommand(bus, msg);
+    }
+}
+
+void OneWireTask::sendCommand(uint8_t bus, const TaskMessage& msg) {
+    if (bus < ONE_WIRE_BUS_COUNT && commandQueues[bus]) {
+        if (xQueueSend(commandQueues[bus], &msg, pdMS_TO_TICKS(100)) != pdPASS) {
+            Logger::error("Failed to send command to OneWire task " + String(bus));
         }
     } else {
         Logger::error("Command queue not initialized");
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,8 @@
 #include "PreferencesApiHandler.h"
 #include <Arduino.h>
 #include "PreferencesManager.h"
+#include "OneWireTask.h"
+#include "NetworkTask.h"
 
 String PreferencesApiHandler::handleGet() {
     Logger::debug("Building preferences JSON response");
@@ -33,16 +35,30 @@ String PreferencesApiHandler::handleGet() {
     
     // Add sensor mappings
     JsonObject sensors = root.createNestedObject("sensors");
-    const auto& sensorList = oneWireManager.getSensorList();  // Use oneWireManager instead of owManager
+    const auto sensorList = SensorRegistry::getSensors();
     
     for (const auto& sensor : sensorList) {
         String addr = PreferencesManager::addressToString(sensor.address);  // Use PreferencesManager's method
-        String name = PreferencesManager::getSensorName(sensor.address);
+        String name = SensorRegistry::getSensorName(sensor.address);
         if (name.length() > 0) {
             sensors[addr] = name;
         }
     }
     
+    // Add per-sensor conversion resolution
+    JsonObject resolutions = root.createNestedObject("resolutions");
+    for (const auto& sensor : sensorList) {
+        String addr = PreferencesManager::addressToString(sensor.address);
+        resolutions[addr] = sensor.resolution;
+    }
+    
+    // Add per-sensor signal filter
+    JsonObject filters = root.createNestedObject("filters");
+    for (const auto& sensor : sensorList) {
+        String addr = PreferencesManager::addressToString(sensor.address);
+        filters[addr] = SensorFilter::typeName(static_cast<FilterType>(sensor.filterType));
+    }
+    
     String output;
     serializeJson(doc, output);
     Logger::debug("Generated preferences JSON: " + output);
@@ -103,7 +119,7 @@ void PreferencesApiHandler::addSensorNamesToJson(JsonObject& root) {
     
     // Add size check
     if (!sensors.isNull()) {
-        const auto& sensorList = oneWireManager.getSensorList();
+        const auto sensorList = SensorRegistry::getSensors();
         
         for (const auto& sensor : sensorList) {
             // Check available heap before allocation
@@ -121,13 +137,15 @@ void PreferencesApiHandler::addSensorNamesToJson(JsonObject& root) {
             String addr = PreferencesManager::addressToString(sensor.address);
             // Only attempt to get name if address is valid
             String name = addr.length() > 0 ? 
-                         PreferencesManager::getSensorName(sensor.address) : "";
+                         SensorRegistry::getSensorName(sensor.address) : "";
             
             sensorObj["address"] = addr;
             if (name.length() > 0) {
                 sensorObj["name"] = name;
             }
-            sensorObj["temperature"] = sensor.temperature;
+            char tempStr[FixedPoint::TEMP_BUFFER_SIZE];
+            FixedPoint::formatTemperature(sensor.temperatureRaw, FixedPoint::JSON_DECIMALS, tempStr);
+            sensorObj["temperature"] = serialized(String(tempStr));
             sensorObj["valid"] = sensor.valid;
         }
     }
@@ -147,27 +165,23 @@ bool PreferencesApiHandler::handlePost(const String& jsonData) {
     serializeJson(doc, debug);
     Logger::debug("Received data: " + debug);
     
-    bool success = true;
+    // Stage everything first; nothing is saved unless every section is valid
+    PreferencesTransaction transaction;
     bool mqttUpdated = false;
     bool scanningUpdated = false;
     bool sensorsUpdated = false;
     bool relaysUpdated = false;
+    bool resolutionsUpdated = false;
+    bool filtersUpdated = false;
     bool displayUpdated = false;
     
     // Process MQTT settings
     if (doc.containsKey("mqtt")) {
         JsonObject mqtt = doc["mqtt"];
         if (validateMqttConfig(mqtt)) {
-            if (updateMqttConfig(mqtt)) {
-                Logger::info("MQTT configuration saved");
-                mqttUpdated = true;
-            } else {
-                Logger::error("Failed to save MQTT configuration");
-                success = false;
-            }
+            mqttUpdated = updateMqttConfig(transaction, mqtt);
         } else {
-            Logger::error("Invalid MQTT configuration");
-            success = false;
+            transaction.reject("invalid MQTT configuration");
         }
     }
     
@@ -175,42 +189,35 @@ bool PreferencesApiHandler::handlePost(const String& jsonData) {
     if (doc.containsKey("sensors")) {
         JsonVariant sensors = doc["sensors"];
         Logger::debug("Processing sensors update");
-        if (updateSensorNames(sensors)) {
-            Logger::info("Sensor names updated successfully");
-            sensorsUpdated = true;
-        } else {
-            Logger::error("Failed to update sensor names");
-            success = false;
-        }
+        sensorsUpdated = updateSensorNames(transaction, sensors);
+    }
+    
+    // Process sensor resolutions
+    if (doc.containsKey("resolutions")) {
+        JsonVariant resolutions = doc["resolutions"];
+        resolutionsUpdated = updateSensorResolutions(transaction, resolutions);
+    }
+    
+    // Process sensor filters
+    if (doc.containsKey("filters")) {
+        JsonVariant filters = doc["filters"];
+        filtersUpdated = updateSensorFilters(transaction, filters);
     }
     
     // Process relay names
     if (doc.containsKey("relays")) {
         JsonArray relays = doc["relays"];
         Logger::debug("Processing relay names update");
-        if (updateRelayNames(relays)) {
-            Logger::info("Relay names updated successfully");
-            relaysUpdated = true;
-        } else {
-            Logger::error("Failed to update relay names");
-            success = false;
-        }
+        relaysUpdated = updateRelayNames(transaction, relays);
     }
     
     // Process scanning settings
     if (doc.containsKey("scanning")) {
         JsonObject scanning = doc["scanning"];
         if (validateScanningConfig(scanning)) {
-            if (updateScanningConfig(scanning)) {
-                Logger::info("Scanning configuration saved");
-                scanningUpdated = true;
-            } else {
-                Logger::error("Failed to save scanning configuration");
-                success = false;
-            }
+            scanningUpdated = updateScanningConfig(transaction, scanning);
         } else {
-            Logger::error("Invalid scanning configuration");
-            success = false;
+            transaction.reject("invalid scanning configuration");
         }
     }
     
@@ -218,16 +225,32 @@ bool PreferencesApiHandler::handlePost(const String& jsonData) {
     if (doc.containsKey("display")) {
         JsonObject display = doc["display"];
         if (validateDisplayConfig(display)) {
-            if (updateDisplayConfig(display)) {
-                Logger::info("Display configuration saved");
-                displayUpdated = true;
-            } else {
-                Logger::error("Failed to save display configuration");
-                success = false;
-            }
+            displayUpdated = updateDisplayConfig(transaction, display);
         } else {
-            Logger::error("Invalid display configuration");
-            success = false;
+            transaction.reject("invalid display configuration");
+        }
+    }
+    
+    // Every change goes to flash in one flush
+    bool success = transaction.commit();
+    if (!success) {
+        mqttUpdated = scanningUpdated = sensorsUpdated = relaysUpdated = false;
+        resolutionsUpdated = filtersUpdated = displayUpdated = false;
+    }
+    
+    // Reprogram the sensors from the OneWire task, only for values that really
+    // changed. The reload also refreshes the known-device cache, which holds
+    // the names.
+    bool namesChanged = success && transaction.changed(ConfigKey::SENSOR_NAME);
+    if (namesChanged || (success && (transaction.changed(ConfigKey::SENSOR_RESOLUTION) ||
+                                     transaction.changed(ConfigKey::SENSOR_FILTER)))) {
+        TaskMessage msg;
+        msg.type = MessageType::SENSOR_CONFIG_CHANGED;
+        OneWireTask::sendCommand(msg);
+        
+        // New names go out with the discovery metadata
+        if (namesChanged) {
+            NetworkTask::enqueuePublication(msg);
         }
     }
     
@@ -235,6 +258,8 @@ bool PreferencesApiHandler::handlePost(const String& jsonData) {
     String updateSummary = "Updates completed - ";
     updateSummary += mqttUpdated ? "MQTT:✓ " : "MQTT:✗ ";
     updateSummary += sensorsUpdated ? "Sensors:✓ " : "Sensors:✗ ";
+    updateSummary += resolutionsUpdated ? "Resolutions:✓ " : "Resolutions:✗ ";
+    updateSummary += filtersUpdated ? "Filters:✓ " : "Filters:✗ ";
     updateSummary += relaysUpdated ? "Relays:✓ " : "Relays:✗ ";
     updateSummary += scanningUpdated ? "Scanning:✓ " : "Scanning:✗ ";
     updateSummary += displayUpdated ? "Display:✓ " : "Display:✗ ";
@@ -323,10 +348,11 @@ bool PreferencesApiHandler::validateDisplayConfig(JsonObject& display) {
     return isValid;
 }
 
-bool PreferencesApiHandler::updateSensorNames(JsonVariant sensors) {
+// The update helpers stage into the transaction and return whether the
+// section was well-formed; any bad entry also rejects the transaction
+bool PreferencesApiHandler::updateSensorNames(PreferencesTransaction& transaction, JsonVariant sensors) {
     if (!sensors.is<JsonObject>()) {
-        Logger::error("Invalid sensors data format - expected object");
-        return false;
+        return transaction.reject("sensors data format - expected object");
     }
     
     JsonObject sensorObj = sensors.as<JsonObject>();
@@ -335,80 +361,109 @@ bool PreferencesApiHandler::updateSensorNames(JsonVariant sensors) {
     bool success = true;
     for (JsonPair kvp : sensorObj) {
         const char* address = kvp.key().c_str();
-        const char* name = kvp.value().as<const char*>();
-        
-        Logger::debug("Setting name for sensor " + String(address) + " -> " + String(name));
+        const char* name = kvp.value() | "";
         
         if (strlen(address) != 16) {
-            Logger::error("Invalid sensor address length: " + String(address));
-            success = false;
+            success = transaction.reject("sensor address length");
             continue;
         }
         
         uint8_t addr[8];
         PreferencesManager::stringToAddress(String(address), addr);
+        success &= transaction.setSensorName(addr, name);
+    }
+    
+    return success;
+}
+
+
+bool PreferencesApiHandler::updateSensorResolutions(PreferencesTransaction& transaction, 
+                                                    JsonVariant resolutions) {
+    if (!resolutions.is<JsonObject>()) {
+        return transaction.reject("resolutions data format - expected object");
+    }
+    
+    bool success = true;
+    for (JsonPair kvp : resolutions.as<JsonObject>()) {
+        const char* address = kvp.key().c_str();
+        int bits = kvp.value() | 0;
         
-        if (!PreferencesManager::setSensorName(addr, name)) {
-            Logger::error("Failed to save name for sensor: " + String(address));
-            success = false;
-        } else {
-            Logger::info("Successfully saved name for sensor: " + String(address));
+        if (strlen(address) != 16) {
+            success = transaction.reject("sensor address length");
+            continue;
         }
+        
+        uint8_t addr[8];
+        PreferencesManager::stringToAddress(String(address), addr);
+        success &= transaction.setSensorResolution(addr, bits < 0 || bits > 0xFF ? 0 : bits);
     }
     
     return success;
 }
 
+bool PreferencesApiHandler::updateSensorFilters(PreferencesTransaction& transaction, 
+                                                JsonVariant filters) {
+    if (!filters.is<JsonObject>()) {
+        return transaction.reject("filters data format - expected object");
+    }
+    
+    bool success = true;
+    for (JsonPair kvp : filters.as<JsonObject>()) {
+        const char* address = kvp.key().c_str();
+        const char* name = kvp.value() | "";
+        
+        if (strlen(address) != 16) {
+            success = transaction.reject("sensor address length");
+            continue;
+        }
+        
+        FilterType type;
+        if (!SensorFilter::parseType(name, type)) {
+            success = transaction.reject("unknown filter");
+            continue;
+        }
+        
+        uint8_t addr[8];
+        PreferencesManager::stringToAddress(String(address), addr);
+        success &= transaction.setSensorFilter(addr, type);
+    }
+    
+    return success;
+}
 
-
-bool PreferencesApiHandler::updateMqttConfig(JsonObject& mqtt) {
+bool PreferencesApiHandler::updateMqttConfig(PreferencesTransaction& transaction, JsonObject& mqtt) {
     const char* broker = mqtt["broker"];
     uint16_t port = mqtt["port"];
     const char* username = mqtt["username"] | "";
     const char* password = mqtt["password"] | "";
     
-    return PreferencesManager::setMqttConfig(broker, port, username, password);
+    return transaction.setMqttConfig(broker, port, username, password);
 }
 
-bool PreferencesApiHandler::updateScanningConfig(JsonObject& scanning) {
+bool PreferencesApiHandler::updateScanningConfig(PreferencesTransaction& transaction, 
+                                                 JsonObject& scanning) {
+    bool success = true;
     if (scanning.containsKey("autoScanEnabled")) {
-        PreferencesManager::setAutoScanEnabled(scanning["autoScanEnabled"]);
+        success &= transaction.setAutoScanEnabled(scanning["autoScanEnabled"]);
     }
     
     if (scanning.containsKey("scanInterval")) {
-        uint32_t interval = scanning["scanInterval"];
-        if (interval >= MIN_SCAN_INTERVAL && interval <= MAX_SCAN_INTERVAL) {
-            PreferencesManager::setScanInterval(interval);
-        }
+        success &= transaction.setScanInterval(scanning["scanInterval"]);
     }
     
-    return true;
+    return success;
 }
 
-bool PreferencesApiHandler::updateDisplayConfig(JsonObject& display) {
-    bool success = true;
+bool PreferencesApiHandler::updateDisplayConfig(PreferencesTransaction& transaction, 
+                                                JsonObject& display) {
+    if (!display.containsKey("selectedSensor")) return true;
     
-    if (display.containsKey("selectedSensor")) {
-        Logger::debug("Display sensor selection update requested");
-        const char* sensorAddr = display["selectedSensor"];
-        Logger::debug("Selected sensor address: " + String(sensorAddr));
-        
-        uint8_t address[8];
-        PreferencesManager::stringToAddress(sensorAddr, address);
-        
-        // Log the converted address
-        String addrStr;
-        for (int i = 0; i < 8; i++) {
-            if (i > 0) addrStr += ":";
-            addrStr += String(address[i], HEX);
-        }
-        Logger::debug("Converting address string to bytes: " + addrStr);
-        
-        success = PreferencesManager::setDisplaySensor(address);
-        Logger::debug("Display sensor update " + String(success ? "succeeded" : "failed"));
-    }
+    const char* sensorAddr = display["selectedSensor"];
+    Logger::debug("Selected display sensor: " + String(sensorAddr));
     
-    return success;
+    uint8_t address[8];
+    PreferencesManager::stringToAddress(sensorAddr, address);
+    return transaction.setDisplaySensor(address);
 }
 
 bool PreferencesApiHandler::validateHostname(const char* hostname) {
@@ -436,7 +491,7 @@ bool PreferencesApiHandler::validateHostname(const char* hostname) {
     return true;
 }
 
-bool PreferencesApiHandler::updateRelayNames(JsonArray& relays) {
+bool PreferencesApiHandler::updateRelayNames(PreferencesTransaction& transaction, JsonArray& relays) {
     Logger::debug("Processing " + String(relays.size()) + " relay names");
     bool success = true;
 
@@ -449,14 +504,11 @@ bool PreferencesApiHandler::updateRelayNames(JsonArray& relays) {
         int relayId = relay["relay_id"];
         const char* name = relay["name"];
 
-        Logger::debug("Setting name for relay " + String(relayId) + " -> " + String(name));
-
-        if (!PreferencesManager::setRelayName(relayId, name)) {
-            Logger::error("Failed to save name for relay " + String(relayId));
-            success = false;
-        } else {
-            Logger::info("Successfully saved name for relay " + String(relayId));
+        if (relayId < 0 || relayId > 0xFF) {
+            success = transaction.reject("relay id");
+            continue;
         }
+        success &= transaction.setRelayName(relayId, name);
     }
 
     return success;
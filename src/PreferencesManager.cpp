@@ -1,10 +1,20 @@
 // src/PreferencesManager.cpp
 #include "PreferencesManager.h"
+#ifdef ARDUINO
 #include "ESP32PreferenceStorage.h"
+#else
+#include "FilePreferenceStorage.h"
+#endif
 
 // Static member initialization
 PreferenceStorage* PreferencesManager::prefs = nullptr;
 SemaphoreHandle_t PreferencesManager::prefsMutex = nullptr;
+ConfigCache PreferencesManager::cache;
+TaskHandle_t PreferencesManager::flushTaskHandle = nullptr;
+PreferencesManager::ChangeListener PreferencesManager::listeners[MAX_LISTENERS] = {};
+uint8_t PreferencesManager::listenerCount = 0;
+uint8_t PreferencesManager::legacyRoms[SensorMetadataTable::CAPACITY][8] = {};
+uint8_t PreferencesManager::legacyCount = 0;
 
 void PreferencesManager::init() {
     Logger::info("Initializing PreferencesManager");
@@ -21,7 +31,7 @@ void PreferencesManager::init() {
 
     // Create preferences storage if it doesn't exist
     if (!prefs) {
-        prefs = new ESP32PreferenceStorage();
+        prefs = createStorage();
         if (!prefs) {
             Logger::error("Failed to create preferences storage");
             return;
@@ -35,7 +45,7 @@ void PreferencesManager::init() {
         
         // Clean up and try again
         delete prefs;
-        prefs = new ESP32PreferenceStorage();
+        prefs = createStorage();
         
         if (!prefs->begin("tempmon", false)) {
             Logger::error("Storage recovery failed - system may need reset");
@@ -73,9 +83,106 @@ void PreferencesManager::init() {
             Logger::info("Default configurations set successfully");
         }
         
+        loadCache();
         releaseMutex();
         Logger::info("PreferencesManager initialization complete");
     }
+    
+    if (!flushTaskHandle) {
+        xTaskCreatePinnedToCore(flushTask, "PrefsFlush", PREFS_FLUSH_TASK_STACK_SIZE, nullptr,
+                                PREFS_FLUSH_TASK_PRIORITY, &flushTaskHandle, NETWORK_TASK_CORE);
+        if (!flushTaskHandle) {
+            Logger::error("Failed to create preferences flush task");
+        }
+    }
+}
+
+// NVS on the device, a file in the working directory on a host build
+PreferenceStorage* PreferencesManager::createStorage() {
+#ifdef ARDUINO
+    return new ESP32PreferenceStorage();
+#else
+    return new FilePreferenceStorage(PREFERENCES_FILE);
+#endif
+}
+
+// Takes ownership; lets a host build use a storage with faults or counters
+// it can inspect. Only before init().
+void PreferencesManager::setStorage(PreferenceStorage* storage) {
+    if (prefs) {
+        Logger::error("Preferences storage already in use");
+        return;
+    }
+    prefs = storage;
+}
+
+// All settings into RAM; called with the mutex held
+void PreferencesManager::loadCache() {
+    static SensorMetadataTable table;  // Guarded by prefsMutex
+    size_t len = prefs->getBytes(SENSOR_METADATA_KEY, &table, sizeof(table));
+    if (!table.isValid(len)) {
+        table.clear();  // Sensors pick up any pre-table keys as buses find them
+    }
+
+    String display = prefs->getString("display_sensor", "0000000000000000");
+    String relay0 = prefs->getString("relay_0", "");
+    String relay1 = prefs->getString("relay_1", "");
+    String broker = prefs->getString("mqtt.broker", "");
+    String user = prefs->getString("mqtt.username", "");
+    String pass = prefs->getString("mqtt.password", "");
+    bool autoScan = prefs->getUInt("auto_scan", 1) != 0;
+    uint32_t scanInterval = prefs->getUInt("scan_interval", DEFAULT_SCAN_INTERVAL);
+    uint16_t port = (uint16_t)prefs->getUInt("mqtt.port", 0);
+    
+    cache.write([&](ConfigCache& c) {
+        stringToAddress(display, c.displaySensor);
+        c.autoScan = autoScan;
+        c.scanInterval = scanInterval;
+        strlcpy(c.relayNames[0], relay0.c_str(), sizeof(c.relayNames[0]));
+        strlcpy(c.relayNames[1], relay1.c_str(), sizeof(c.relayNames[1]));
+        strlcpy(c.mqttServer, broker.c_str(), sizeof(c.mqttServer));
+        c.mqttPort = port;
+        strlcpy(c.mqttUsername, user.c_str(), sizeof(c.mqttUsername));
+        strlcpy(c.mqttPassword, pass.c_str(), sizeof(c.mqttPassword));
+        memcpy(&c.sensors, &table, table.size());
+        c.sensors.index = table.index;
+        c.dirty = 0;
+        c.dirtyRelays = 0;
+    });
+}
+
+// Settings older firmware kept under per-sensor keys named after the last
+// four ROM bytes, over the defaults in entry. NVS keys cannot be enumerated,
+// so each sensor is looked up when a bus finds it or a setting of it changes.
+// Called with the mutex held; true if any key was there.
+bool PreferencesManager::readLegacySensorKeys(const uint8_t* address, SensorMetadataTable::Entry& entry) {
+    String name = prefs->getString(getSensorKey(address).c_str(), "");
+    uint32_t bits = prefs->getUInt(getSensorKey(address, "r_").c_str(), LEGACY_KEY_MISSING);
+    uint32_t filter = prefs->getUInt(getSensorKey(address, "f_").c_str(), LEGACY_KEY_MISSING);
+    
+    strlcpy(entry.name, name.c_str(), sizeof(entry.name));
+    if (bits >= MIN_SENSOR_RESOLUTION && bits <= MAX_SENSOR_RESOLUTION) {
+        entry.resolution = bits;
+    }
+    if (filter < static_cast<uint32_t>(FilterType::COUNT)) {
+        entry.filter = filter;
+    }
+    return name.length() > 0 || bits != LEGACY_KEY_MISSING || filter != LEGACY_KEY_MISSING;
+}
+
+// The pre-table keys of sensors moved into the table, once the table holding
+// them is stored. Called with the mutex held.
+void PreferencesManager::removeLegacySensorKeys() {
+    for (uint8_t i = 0; i < legacyCount; i++) {
+        const uint8_t* rom = legacyRoms[i];
+        prefs->remove(getSensorKey(rom).c_str());
+        prefs->remove(getSensorKey(rom, "r_").c_str());
+        prefs->remove(getSensorKey(rom, "f_").c_str());
+    }
+    if (legacyCount) {
+        Logger::info("Moved settings of " + String(legacyCount) + " sensors to the metadata table");
+    }
+    legacyCount = 0;
 }
 
 void PreferencesManager::reset() {
@@ -153,130 +260,200 @@ bool PreferencesManager::removeCredential(const char* key) {
 }
 
 // MQTT Configuration Methods
-// In PreferencesManager.cpp, modify the MQTT config methods:
-
+// An empty password keeps the stored one
 bool PreferencesManager::setMqttConfig(const char* server, uint16_t port, 
-    const char* username, const char* password) {
-if (!isInitialized()) return false;
-
-bool success = false;
-if (acquireMutex("setMqttConfig")) {
-// Remove any existing broker config first
-prefs->remove("mqtt.broker");
-
-// Store the new broker address directly
-success = prefs->putString("mqtt.broker", server);
-Logger::debug("Setting MQTT broker to: " + String(server));
-
-if (success) {
-success &= prefs->putUInt("mqtt.port", port);
-success &= prefs->putString("mqtt.username", username);
-
-if (password && strlen(password) > 0) {
-success &= prefs->putString("mqtt.password", password);
-}
-}
-
-// Verify the stored value
-String storedBroker = prefs->getString("mqtt.broker", "");
-Logger::debug("Verified stored broker: " + storedBroker);
-
-releaseMutex();
-Logger::info("MQTT configuration " + String(success ? "saved" : "failed"));
-}
-return success;
+                                       const char* username, const char* password) {
+    if (!isInitialized() || !server || !username) return false;
+    
+    if (!acquireMutex("setMqttConfig")) return false;
+    cache.write([&](ConfigCache& c) {
+        strlcpy(c.mqttServer, server, sizeof(c.mqttServer));
+        c.mqttPort = port;
+        strlcpy(c.mqttUsername, username, sizeof(c.mqttUsername));
+        if (password && strlen(password) > 0) {
+            strlcpy(c.mqttPassword, password, sizeof(c.mqttPassword));
+        }
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::MQTT);
+    });
+    releaseMutex();
+    
+    Logger::debug("Setting MQTT broker to: " + String(server));
+    Logger::info("MQTT configuration saved");
+    changed(ConfigKey::MQTT);
+    return true;
 }
 
 void PreferencesManager::getMqttConfig(char* server, unsigned short& port, 
-    char* username, char* password) {
-if (!isInitialized()) return;
-
-if (acquireMutex("getMqttConfig")) {
-// Get broker address directly
-String broker = prefs->getString("mqtt.broker", "");
-Logger::debug("Retrieved MQTT broker: " + broker);
-
-// Copy broker address safely
-strncpy(server, broker.c_str(), MAX_MQTT_SERVER_LENGTH - 1);
-server[MAX_MQTT_SERVER_LENGTH - 1] = '\0';
-
-port = (unsigned short)prefs->getUInt("mqtt.port", 0);
-
-String user = prefs->getString("mqtt.username", "");
-strncpy(username, user.c_str(), MAX_MQTT_CRED_LENGTH - 1);
-username[MAX_MQTT_CRED_LENGTH - 1] = '\0';
-
-String pass = prefs->getString("mqtt.password", "");
-strncpy(password, pass.c_str(), MAX_MQTT_CRED_LENGTH - 1);
-password[MAX_MQTT_CRED_LENGTH - 1] = '\0';
-
-releaseMutex();
-}
+                                       char* username, char* password) {
+    if (!isInitialized()) return;
+    
+    cache.read([&](const ConfigCache& c) {
+        strlcpy(server, c.mqttServer, MAX_MQTT_SERVER_LENGTH);
+        port = c.mqttPort;
+        strlcpy(username, c.mqttUsername, MAX_MQTT_CRED_LENGTH);
+        strlcpy(password, c.mqttPassword, MAX_MQTT_CRED_LENGTH);
+    });
 }
 
 bool PreferencesManager::isMqttConfigured() {
     if (!isInitialized()) return false;
     
     bool configured = false;
-    if (acquireMutex("isMqttConfigured")) {
-        String broker = prefs->getString("mqtt.broker", "");
-        uint32_t port = prefs->getUInt("mqtt.port", 0);
-        configured = (broker.length() > 0 && port > 0);
-        releaseMutex();
-    }
+    cache.read([&configured](const ConfigCache& c) {
+        configured = c.mqttServer[0] != '\0' && c.mqttPort > 0;
+    });
     return configured;
 }
 
 bool PreferencesManager::clearMqttConfig() {
     if (!isInitialized()) return false;
     
-    bool success = false;
-    if (acquireMutex("clearMqttConfig")) {
-        success = true;
-        success &= prefs->remove("mqtt.broker");
-        success &= prefs->remove("mqtt.port");
-        success &= prefs->remove("mqtt.username");
-        success &= prefs->remove("mqtt.password");
-        releaseMutex();
-    }
-    return success;
+    if (!acquireMutex("clearMqttConfig")) return false;
+    cache.write([](ConfigCache& c) {
+        c.mqttServer[0] = '\0';
+        c.mqttPort = 0;
+        c.mqttUsername[0] = '\0';
+        c.mqttPassword[0] = '\0';
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::MQTT);
+    });
+    releaseMutex();
+    
+    changed(ConfigKey::MQTT);
+    return true;
 }
 
 // Sensor Management Methods
+// Change one field of a sensor's entry and mark the table for the next flush.
+// A sensor without an entry only gets one if the value differs from its
+// current setting.
+template <typename Fn>
+bool PreferencesManager::updateSensor(const uint8_t* address, ConfigKey key, Fn&& fn) {
+    if (!acquireMutex("updateSensor")) return false;
+    
+    SensorMetadataTable::Entry entry;
+    bool legacy = false;
+    int index = loadSensor(address, entry, legacy);
+    SensorMetadataTable::Entry updated = entry;
+    fn(updated);
+    bool modified = !updated.sameSettings(entry);
+    if (modified || legacy) {
+        index = storeSensor(index, updated, legacy, 
+                            modified ? ConfigCache::dirtyBit(key) : ConfigCache::SENSOR_BITS);
+    }
+    releaseMutex();
+    
+    if (index == SensorMetadataTable::NOT_FOUND && (modified || legacy)) return false;
+    if (modified) {
+        changed(key, address);
+    } else if (legacy) {
+        scheduleFlush();
+    }
+    return true;
+}
+
+// Copy from a sensor's entry without locking. fn is not called for a sensor
+// without one, which uses the defaults.
+template <typename Fn>
+void PreferencesManager::readSensor(const uint8_t* address, Fn&& fn) {
+    cache.read([&](const ConfigCache& c) {
+        int index = c.sensors.find(address);
+        if (index != SensorMetadataTable::NOT_FOUND) fn(c.sensors.entries[index]);
+    });
+}
+
 bool PreferencesManager::setSensorName(const uint8_t* address, const char* name) {
     if (!isInitialized() || !address || !name) {
         Logger::error("Invalid parameters in setSensorName");
         return false;
     }
     
-    bool success = false;
-    if (acquireMutex("setSensorName")) {
-        String key = getSensorKey(address);
-        Logger::debug("Setting sensor name with key: " + key + ", name: " + String(name));
-        
-        success = prefs->putString(key.c_str(), name);
-        if (success) {
-            Logger::info("Saved name '" + String(name) + "' for sensor " + addressToString(address));
-        } else {
-            Logger::error("Failed to save sensor name '" + String(name) + "' for key: " + key);
-        }
-        releaseMutex();
-    } else {
-        Logger::error("Failed to acquire mutex in setSensorName");
+    if (!updateSensor(address, ConfigKey::SENSOR_NAME, [name](SensorMetadataTable::Entry& entry) {
+            strlcpy(entry.name, name, sizeof(entry.name));
+        })) {
+        Logger::error("Failed to save sensor name '" + String(name) + "'");
+        return false;
     }
-    return success;
+    Logger::info("Saved name '" + String(name) + "' for sensor " + addressToString(address));
+    return true;
 }
 
 String PreferencesManager::getSensorName(const uint8_t* address) {
     if (!isInitialized() || !address) return "";
     
-    String name;
-    if (acquireMutex("getSensorName")) {
-        String key = getSensorKey(address);
-        name = prefs->getString(key.c_str(), "");
-        releaseMutex();
+    char name[MAX_SENSOR_NAME_LENGTH] = "";
+    readSensor(address, [&name](const SensorMetadataTable::Entry& entry) {
+        memcpy(name, entry.name, sizeof(name));
+    });
+    return String(name);
+}
+
+// Index of a sensor's entry with a copy in entry. For a sensor without one,
+// NOT_FOUND and the defaults over the settings of any pre-table keys, with
+// legacy set if there were some. Called with the mutex held.
+int PreferencesManager::loadSensor(const uint8_t* address, SensorMetadataTable::Entry& entry, 
+                                   bool& legacy) {
+    legacy = false;
+    int index = cache.sensors.find(address);
+    if (index != SensorMetadataTable::NOT_FOUND) {
+        entry = cache.sensors.entries[index];
+        return index;
+    }
+    entry.setDefaults(address);
+    legacy = readLegacySensorKeys(address, entry);
+    return index;
+}
+
+// Store entry at index, adding the sensor to the table for NOT_FOUND, and
+// mark dirty for the next flush. Called with the mutex held. NOT_FOUND only
+// if the table is full of sensors with settings of their own.
+int PreferencesManager::storeSensor(int index, const SensorMetadataTable::Entry& entry, bool legacy,
+                                    uint32_t dirty) {
+    cache.write([&](ConfigCache& c) {
+        if (index == SensorMetadataTable::NOT_FOUND) index = c.sensors.add(entry.rom);
+        if (index == SensorMetadataTable::NOT_FOUND) return;
+        c.sensors.entries[index] = entry;
+        c.dirty |= dirty;
+    });
+    if (index == SensorMetadataTable::NOT_FOUND) {
+        Logger::error("Sensor metadata table full - cannot add " + addressToString(entry.rom));
+        return index;
+    }
+    
+    // Its old keys go once the table holding the entry is stored
+    if (legacy && legacyCount < SensorMetadataTable::CAPACITY) {
+        memcpy(legacyRoms[legacyCount++], entry.rom, 8);
     }
-    return name;
+    return index;
+}
+
+// A bus found the sensor. The first time per boot, settings it still has
+// under pre-table keys move into the table. Sensors with an entry cost one
+// lock-free lookup.
+void PreferencesManager::sensorFound(const uint8_t* address) {
+    if (!prefs || !prefsMutex || !address) return;
+    
+    bool known = false;
+    cache.read([&](const ConfigCache& c) {
+        known = c.sensors.find(address) != SensorMetadataTable::NOT_FOUND;
+    });
+    if (known || !acquireMutex("sensorFound")) return;
+    
+    // Once full, sensors are looked up again on every scan
+    static RomIndex<SensorMetadataTable::CAPACITY> probed;  // Guarded by prefsMutex
+    uint64_t key = RomIndex<SensorMetadataTable::CAPACITY>::toKey(address);
+    bool added = false;
+    if (probed.find(key) == RomIndex<SensorMetadataTable::CAPACITY>::NOT_FOUND) {
+        probed.insert(key, 0);
+        SensorMetadataTable::Entry entry;
+        bool legacy = false;
+        int index = loadSensor(address, entry, legacy);
+        if (index == SensorMetadataTable::NOT_FOUND && legacy) {
+            added = storeSensor(index, entry, true, ConfigCache::SENSOR_BITS) != SensorMetadataTable::NOT_FOUND;
+        }
+    }
+    releaseMutex();
+    
+    if (added) scheduleFlush();
 }
 
 // Utility Methods
@@ -307,9 +484,101 @@ bool PreferencesManager::isInitialized() {
     return true;
 }
 
-String PreferencesManager::getSensorKey(const uint8_t* address) {
+bool PreferencesManager::setSensorResolution(const uint8_t* address, uint8_t bits) {
+    if (!isInitialized() || !address || 
+        bits < MIN_SENSOR_RESOLUTION || bits > MAX_SENSOR_RESOLUTION) {
+        Logger::error("Invalid parameters in setSensorResolution");
+        return false;
+    }
+    
+    if (!updateSensor(address, ConfigKey::SENSOR_RESOLUTION, [bits](SensorMetadataTable::Entry& entry) {
+            entry.resolution = bits;
+        })) {
+        Logger::error("Failed to save sensor resolution");
+        return false;
+    }
+    Logger::info("Saved resolution " + String(bits) + " bit for sensor " + addressToString(address));
+    return true;
+}
+
+uint8_t PreferencesManager::getSensorResolution(const uint8_t* address) {
+    if (!isInitialized() || !address) return DEFAULT_SENSOR_RESOLUTION;
+    
+    uint8_t bits = DEFAULT_SENSOR_RESOLUTION;
+    readSensor(address, [&bits](const SensorMetadataTable::Entry& entry) {
+        bits = entry.resolution;
+    });
+    return bits;
+}
+
+bool PreferencesManager::setSensorFilter(const uint8_t* address, FilterType type) {
+    if (!isInitialized() || !address || type >= FilterType::COUNT) {
+        Logger::error("Invalid parameters in setSensorFilter");
+        return false;
+    }
+    
+    if (!updateSensor(address, ConfigKey::SENSOR_FILTER, [type](SensorMetadataTable::Entry& entry) {
+            entry.filter = static_cast<uint8_t>(type);
+        })) {
+        Logger::error("Failed to save sensor filter");
+        return false;
+    }
+    Logger::info("Saved filter " + String(SensorFilter::typeName(type)) + 
+                " for sensor " + addressToString(address));
+    return true;
+}
+
+FilterType PreferencesManager::getSensorFilter(const uint8_t* address) {
+    if (!isInitialized() || !address) return FilterType::NONE;
+    
+    uint8_t type = static_cast<uint8_t>(FilterType::NONE);
+    readSensor(address, [&type](const SensorMetadataTable::Entry& entry) {
+        type = entry.filter;
+    });
+    return static_cast<FilterType>(type);
+}
+
+// Rewrites the blob only when it differs from what is stored, so repeated scans
+// of an unchanged bus cost no flash writes
+bool PreferencesManager::setKnownDevices(uint8_t bus, const KnownDeviceCache& cache) {
+    if (!isInitialized()) return false;
+    
+    static KnownDeviceCache stored;  // Guarded by prefsMutex
+    bool success = false;
+    if (acquireMutex("setKnownDevices")) {
+        String key = "kd_" + String(bus);
+        size_t len = cache.size();
+        if (prefs->getBytes(key.c_str(), &stored, sizeof(stored)) == len &&
+            memcmp(&stored, &cache, len) == 0) {
+            success = true;
+        } else {
+            success = prefs->putBytes(key.c_str(), &cache, len) == len;
+            if (success) {
+                Logger::info("Saved " + String(cache.count) + " known devices for bus " + String(bus));
+            } else {
+                Logger::error("Failed to save known devices for bus " + String(bus));
+            }
+        }
+        releaseMutex();
+    }
+    return success;
+}
+
+bool PreferencesManager::getKnownDevices(uint8_t bus, KnownDeviceCache& cache) {
+    if (!isInitialized()) return false;
+    
+    size_t len = 0;
+    if (acquireMutex("getKnownDevices")) {
+        String key = "kd_" + String(bus);
+        len = prefs->getBytes(key.c_str(), &cache, sizeof(cache));
+        releaseMutex();
+    }
+    return cache.isValid(len);
+}
+
+String PreferencesManager::getSensorKey(const uint8_t* address, const char* prefix) {
     char key[15];
-    snprintf(key, sizeof(key), "s_%02X%02X%02X%02X",
+    snprintf(key, sizeof(key), "%s%02X%02X%02X%02X", prefix,
              address[4], address[5], address[6], address[7]);
     return String(key);
 }
@@ -324,7 +593,7 @@ String PreferencesManager::addressToString(const uint8_t* address) {
 
 void PreferencesManager::stringToAddress(const String& str, uint8_t* address) {
     Logger::debug("Converting string to address: " + str);
-    for (int i = 0; i < 8; i++) {
+    for (unsigned int i = 0; i < 8; i++) {
         if (str.length() >= (i + 1) * 2) {
             String byteStr = str.substring(i * 2, (i + 1) * 2);
             address[i] = strtol(byteStr.c_str(), nullptr, 16);
@@ -335,42 +604,40 @@ void PreferencesManager::stringToAddress(const String& str, uint8_t* address) {
 }
 
 void PreferencesManager::setAutoScanEnabled(bool enabled) {
-    if (!isInitialized()) return;
+    if (!isInitialized() || !acquireMutex("setAutoScanEnabled")) return;
     
-    if (acquireMutex("setAutoScanEnabled")) {
-        prefs->putUInt("auto_scan", enabled ? 1 : 0);
-        releaseMutex();
-    }
+    cache.write([enabled](ConfigCache& c) {
+        c.autoScan = enabled;
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN);
+    });
+    releaseMutex();
+    changed(ConfigKey::AUTO_SCAN);
 }
 
 bool PreferencesManager::getAutoScanEnabled() {
     if (!isInitialized()) return true;  // Default to enabled
     
     bool enabled = true;
-    if (acquireMutex("getAutoScanEnabled")) {
-        enabled = prefs->getUInt("auto_scan", 1) != 0;
-        releaseMutex();
-    }
+    cache.read([&enabled](const ConfigCache& c) { enabled = c.autoScan; });
     return enabled;
 }
 
 void PreferencesManager::setScanInterval(uint32_t seconds) {
-    if (!isInitialized()) return;
+    if (!isInitialized() || !acquireMutex("setScanInterval")) return;
     
-    if (acquireMutex("setScanInterval")) {
-        prefs->putUInt("scan_interval", seconds);
-        releaseMutex();
-    }
+    cache.write([seconds](ConfigCache& c) {
+        c.scanInterval = seconds;
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL);
+    });
+    releaseMutex();
+    changed(ConfigKey::SCAN_INTERVAL);
 }
 
 uint32_t PreferencesManager::getScanInterval() {
     if (!isInitialized()) return DEFAULT_SCAN_INTERVAL;
     
     uint32_t interval = DEFAULT_SCAN_INTERVAL;
-    if (acquireMutex("getScanInterval")) {
-        interval = prefs->getUInt("scan_interval", DEFAULT_SCAN_INTERVAL);
-        releaseMutex();
-    }
+    cache.read([&interval](const ConfigCache& c) { interval = c.scanInterval; });
     return interval;
 }
 
@@ -380,53 +647,337 @@ void PreferencesManager::getDisplaySensor(uint8_t* address) {
         return;
     }
     
-    if (acquireMutex("getDisplaySensor")) {
-        String addrStr = prefs->getString("display_sensor", "0000000000000000");
-        stringToAddress(addrStr, address);
-        releaseMutex();
-    }
+    cache.read([address](const ConfigCache& c) { memcpy(address, c.displaySensor, 8); });
 }
 
 bool PreferencesManager::setDisplaySensor(const uint8_t* address) {
-    if (!isInitialized()) return false;
+    if (!isInitialized() || !address || !acquireMutex("setDisplaySensor")) return false;
     
-    bool success = false;
-    if (acquireMutex("setDisplaySensor")) {
-        String addrStr = addressToString(address);
-        success = prefs->putString("display_sensor", addrStr.c_str());
-        releaseMutex();
-    }
-    return success;
+    cache.write([address](ConfigCache& c) {
+        memcpy(c.displaySensor, address, 8);
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR);
+    });
+    releaseMutex();
+    changed(ConfigKey::DISPLAY_SENSOR, address);
+    return true;
 }
 
 bool PreferencesManager::setRelayName(uint8_t relayId, const char* name) {
-    if (!isInitialized() || relayId > 1) {
+    if (!isInitialized() || relayId >= ConfigCache::RELAY_COUNT || !name) {
         Logger::error("Invalid parameters in setRelayName");
         return false;
     }
     
-    bool success = false;
-    if (acquireMutex("setRelayName")) {
-        String key = "relay_" + String(relayId);
-        Logger::debug("Setting relay name with key: " + key);
-        
-        success = prefs->putString(key.c_str(), name);
-        if (!success) {
-            Logger::error("Failed to save relay name to storage");
+    if (!acquireMutex("setRelayName")) return false;
+    cache.write([relayId, name](ConfigCache& c) {
+        strlcpy(c.relayNames[relayId], name, sizeof(c.relayNames[relayId]));
+        c.dirtyRelays |= 1 << relayId;
+        c.dirty |= ConfigCache::dirtyBit(ConfigKey::RELAY_NAME);
+    });
+    releaseMutex();
+    Logger::debug("Setting relay name for relay " + String(relayId));
+    changed(ConfigKey::RELAY_NAME);
+    return true;
+}
+
+String PreferencesManager::getRelayName(uint8_t relayId) {
+    if (!isInitialized() || relayId >= ConfigCache::RELAY_COUNT) return "";
+    
+    char name[MAX_SENSOR_NAME_LENGTH] = "";
+    cache.read([&name, relayId](const ConfigCache& c) {
+        memcpy(name, c.relayNames[relayId], sizeof(name));
+    });
+    return String(name);
+}
+
+// Write every dirty setting to NVS. Runs on the flush task, or directly when a
+// caller needs the settings on flash (e.g. before a restart). Entries that
+// fail stay dirty and are retried on the next flush.
+bool PreferencesManager::flush() {
+    if (!isInitialized() || !acquireMutex("flush")) return false;
+    
+    uint32_t failed = 0;
+    uint8_t failedRelays = 0;
+    uint32_t dirty = cache.dirty;
+    
+    if (dirty & ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR)) {
+        if (!prefs->putString("display_sensor", addressToString(cache.displaySensor).c_str())) {
+            failed |= ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR);
         }
-        releaseMutex();
     }
-    return success;
+    if (dirty & ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN)) {
+        if (!prefs->putUInt("auto_scan", cache.autoScan ? 1 : 0)) {
+            failed |= ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN);
+        }
+    }
+    if (dirty & ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL)) {
+        if (!prefs->putUInt("scan_interval", cache.scanInterval)) {
+            failed |= ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL);
+        }
+    }
+    if (dirty & ConfigCache::dirtyBit(ConfigKey::RELAY_NAME)) {
+        for (uint8_t relay = 0; relay < ConfigCache::RELAY_COUNT; relay++) {
+            if (!(cache.dirtyRelays & (1 << relay))) continue;
+            String key = "relay_" + String(relay);
+            if (!prefs->putString(key.c_str(), cache.relayNames[relay])) {
+                failedRelays |= 1 << relay;
+            }
+        }
+        if (failedRelays) failed |= ConfigCache::dirtyBit(ConfigKey::RELAY_NAME);
+    }
+    if (dirty & ConfigCache::dirtyBit(ConfigKey::MQTT)) {
+        bool success = true;
+        if (cache.mqttServer[0] == '\0') {
+            prefs->remove("mqtt.broker");
+            prefs->remove("mqtt.port");
+            prefs->remove("mqtt.username");
+            prefs->remove("mqtt.password");
+        } else {
+            success &= prefs->putString("mqtt.broker", cache.mqttServer);
+            success &= prefs->putUInt("mqtt.port", cache.mqttPort);
+            success &= prefs->putString("mqtt.username", cache.mqttUsername);
+            if (cache.mqttPassword[0] != '\0') {
+                success &= prefs->putString("mqtt.password", cache.mqttPassword);
+            }
+        }
+        if (!success) failed |= ConfigCache::dirtyBit(ConfigKey::MQTT);
+    }
+    
+    if (dirty & ConfigCache::SENSOR_BITS) {
+        size_t len = cache.sensors.size();
+        if (prefs->putBytes(SENSOR_METADATA_KEY, &cache.sensors, len) != len) {
+            failed |= dirty & ConfigCache::SENSOR_BITS;
+        } else {
+            removeLegacySensorKeys();
+        }
+    }
+    
+    cache.dirty = failed;
+    cache.dirtyRelays = failedRelays;
+    releaseMutex();
+    
+    if (failed) {
+        Logger::error("Failed to write some preferences - will retry");
+        return false;
+    }
+    return true;
 }
 
-String PreferencesManager::getRelayName(uint8_t relayId) {
-    if (!isInitialized() || relayId > 1) return "";
+// Apply a whole transaction or nothing. Values equal to what is stored are
+// dropped, the rest goes into the cache in one write and to flash in a single
+// flush before returning.
+bool PreferencesManager::commit(PreferencesTransaction& transaction) {
+    transaction.applied = 0;
+    if (!transaction.isValid()) {
+        Logger::error("Preference transaction has invalid changes - nothing saved");
+        return false;
+    }
+    if (!isInitialized() || !acquireMutex("commit")) return false;
+    
+    using Tx = PreferencesTransaction;
+    const uint32_t staged = transaction.staged;
     
-    String name;
-    if (acquireMutex("getRelayName")) {
-        String key = "relay_" + String(relayId);
-        name = prefs->getString(key.c_str(), "");
+    // Current settings of every staged sensor; sensors without an entry are
+    // not added yet
+    static SensorMetadataTable::Entry current[Tx::MAX_SENSOR_CHANGES];  // Guarded by prefsMutex
+    int indices[Tx::MAX_SENSOR_CHANGES];
+    bool legacy[Tx::MAX_SENSOR_CHANGES];
+    for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+        indices[i] = loadSensor(transaction.sensors[i].address, current[i], legacy[i]);
+    }
+    
+    // Keep only real changes; the cache cannot change while we hold the mutex
+    uint32_t changes = 0;
+    uint8_t relayChanges = 0;
+    uint8_t sensorChanges[Tx::MAX_SENSOR_CHANGES];
+    
+    if ((staged & ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR)) &&
+        memcmp(cache.displaySensor, transaction.displaySensor, 8) != 0) {
+        changes |= ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR);
+    }
+    if ((staged & ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN)) && 
+        cache.autoScan != transaction.autoScan) {
+        changes |= ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN);
+    }
+    if ((staged & ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL)) && 
+        cache.scanInterval != transaction.scanInterval) {
+        changes |= ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL);
+    }
+    for (uint8_t relay = 0; relay < ConfigCache::RELAY_COUNT; relay++) {
+        if ((transaction.relayMask & (1 << relay)) &&
+            strcmp(cache.relayNames[relay], transaction.relayNames[relay]) != 0) {
+            relayChanges |= 1 << relay;
+        }
+    }
+    if (relayChanges) changes |= ConfigCache::dirtyBit(ConfigKey::RELAY_NAME);
+    // An empty password keeps the stored one, as in setMqttConfig
+    if ((staged & ConfigCache::dirtyBit(ConfigKey::MQTT)) &&
+        (strcmp(cache.mqttServer, transaction.mqttServer) != 0 ||
+         cache.mqttPort != transaction.mqttPort ||
+         strcmp(cache.mqttUsername, transaction.mqttUsername) != 0 ||
+         (transaction.mqttPassword[0] != '\0' && 
+          strcmp(cache.mqttPassword, transaction.mqttPassword) != 0))) {
+        changes |= ConfigCache::dirtyBit(ConfigKey::MQTT);
+    }
+    
+    uint32_t sensorChangeMask = 0;
+    for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+        const Tx::SensorChange& change = transaction.sensors[i];
+        const SensorMetadataTable::Entry& entry = current[i];
+        uint8_t fields = 0;
+        if ((change.fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_NAME)) &&
+            strcmp(entry.name, change.name) != 0) {
+            fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_NAME);
+        }
+        if ((change.fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_RESOLUTION)) &&
+            entry.resolution != change.resolution) {
+            fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_RESOLUTION);
+        }
+        if ((change.fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_FILTER)) &&
+            entry.filter != change.filter) {
+            fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_FILTER);
+        }
+        sensorChanges[i] = fields;
+        sensorChangeMask |= fields;
+    }
+    
+    // A sensor gets an entry if it changes, or to take over its pre-table
+    // keys. Check they all fit before applying anything: entries the
+    // transaction changes stop being free for reuse.
+    size_t needed = 0;
+    size_t room = cache.sensors.room();
+    bool adopted = false;
+    for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+        if (indices[i] == SensorMetadataTable::NOT_FOUND) {
+            if (sensorChanges[i] || legacy[i]) needed++;
+            adopted |= legacy[i];
+        } else if (sensorChanges[i] && current[i].isDefault() && room > 0) {
+            room--;
+        }
+    }
+    if (needed > room) {
+        releaseMutex();
+        Logger::error("No room for the sensors of a preference transaction - nothing saved");
+        return false;
+    }
+    
+    if (!changes && !sensorChangeMask && !adopted) {
         releaseMutex();
+        Logger::debug("Preference transaction changes nothing");
+        return true;
+    }
+    
+    cache.write([&](ConfigCache& c) {
+        if (changes & ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR)) {
+            memcpy(c.displaySensor, transaction.displaySensor, 8);
+        }
+        if (changes & ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN)) {
+            c.autoScan = transaction.autoScan;
+        }
+        if (changes & ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL)) {
+            c.scanInterval = transaction.scanInterval;
+        }
+        for (uint8_t relay = 0; relay < ConfigCache::RELAY_COUNT; relay++) {
+            if (relayChanges & (1 << relay)) {
+                strlcpy(c.relayNames[relay], transaction.relayNames[relay], sizeof(c.relayNames[relay]));
+            }
+        }
+        if (changes & ConfigCache::dirtyBit(ConfigKey::MQTT)) {
+            strlcpy(c.mqttServer, transaction.mqttServer, sizeof(c.mqttServer));
+            c.mqttPort = transaction.mqttPort;
+            strlcpy(c.mqttUsername, transaction.mqttUsername, sizeof(c.mqttUsername));
+            if (transaction.mqttPassword[0] != '\0') {
+                strlcpy(c.mqttPassword, transaction.mqttPassword, sizeof(c.mqttPassword));
+            }
+        }
+        for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+            const Tx::SensorChange& change = transaction.sensors[i];
+            SensorMetadataTable::Entry& entry = current[i];
+            uint8_t fields = sensorChanges[i];
+            if (fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_NAME)) {
+                strlcpy(entry.name, change.name, sizeof(entry.name));
+            }
+            if (fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_RESOLUTION)) {
+                entry.resolution = change.resolution;
+            }
+            if (fields & ConfigCache::dirtyBit(ConfigKey::SENSOR_FILTER)) {
+                entry.filter = change.filter;
+            }
+            if (fields && indices[i] != SensorMetadataTable::NOT_FOUND) {
+                c.sensors.entries[indices[i]] = entry;
+                c.dirty |= fields;
+            }
+        }
+        c.dirty |= changes;
+        c.dirtyRelays |= relayChanges;
+    });
+    
+    // New entries last, so none takes the place of an entry changed above
+    for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+        if (indices[i] != SensorMetadataTable::NOT_FOUND || !(sensorChanges[i] || legacy[i])) continue;
+        storeSensor(indices[i], current[i], legacy[i], 
+                    sensorChanges[i] ? sensorChanges[i] : ConfigCache::SENSOR_BITS);
+    }
+    releaseMutex();
+    transaction.applied = changes | sensorChangeMask;
+    
+    for (uint8_t key = 0; key < static_cast<uint8_t>(ConfigKey::SENSOR_NAME); key++) {
+        if (changes & (1UL << key)) {
+            notifyListeners(static_cast<ConfigKey>(key), 
+                            key == static_cast<uint8_t>(ConfigKey::DISPLAY_SENSOR) ?
+                            transaction.displaySensor : nullptr);
+        }
+    }
+    for (uint8_t i = 0; i < transaction.sensorCount; i++) {
+        for (ConfigKey key : {ConfigKey::SENSOR_NAME, ConfigKey::SENSOR_RESOLUTION, 
+                              ConfigKey::SENSOR_FILTER}) {
+            if (sensorChanges[i] & ConfigCache::dirtyBit(key)) {
+                notifyListeners(key, transaction.sensors[i].address);
+            }
+        }
+    }
+    
+    // The changes are live either way; a failed write stays dirty for the flush task
+    if (!flush()) scheduleFlush();
+    Logger::info("Preference transaction saved");
+    return true;
+}
+
+// Waits for changes, lets a burst of them settle, then writes them in one go
+void PreferencesManager::flushTask(void* parameter) {
+    (void)parameter;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(FLUSH_DELAY));
+        ulTaskNotifyTake(pdTRUE, 0);
+        
+        if (!flush()) {
+            vTaskDelay(pdMS_TO_TICKS(FLUSH_RETRY_DELAY));
+            xTaskNotifyGive(flushTaskHandle);
+        }
     }
-    return name;
-}
\ No newline at end of file
+}
+
+bool PreferencesManager::subscribe(ChangeListener listener) {
+    if (!listener || listenerCount >= MAX_LISTENERS) return false;
+    listeners[listenerCount++] = listener;
+    return true;
+}
+
+// Tell subscribers and schedule a flush; called without the mutex held
+void PreferencesManager::changed(ConfigKey key, const uint8_t* address) {
+    notifyListeners(key, address);
+    scheduleFlush();
+}
+
+void PreferencesManager::notifyListeners(ConfigKey key, const uint8_t* address) {
+    for (uint8_t i = 0; i < listenerCount; i++) {
+        listeners[i](key, address);
+    }
+}
+
+void PreferencesManager::scheduleFlush() {
+    if (flushTaskHandle) {
+        xTaskNotifyGive(flushTaskHandle);
+    }
+}
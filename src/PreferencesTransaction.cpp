@@ -0,0 +1,108 @@
+// src/PreferencesTransaction.cpp
+#include "PreferencesTransaction.h"
+#include <cstring>
+#include "PreferencesManager.h"
+#include "Logger.h"
+
+bool PreferencesTransaction::reject(const char* reason) {
+    Logger::error("Rejected preference change: " + String(reason));
+    valid = false;
+    return false;
+}
+
+// Changes for the same sensor share one entry
+PreferencesTransaction::SensorChange* PreferencesTransaction::sensorChange(const uint8_t* address) {
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        if (memcmp(sensors[i].address, address, 8) == 0) return &sensors[i];
+    }
+    if (sensorCount >= MAX_SENSOR_CHANGES) return nullptr;
+
+    SensorChange& change = sensors[sensorCount++];
+    memcpy(change.address, address, 8);
+    change.fields = 0;
+    return &change;
+}
+
+bool PreferencesTransaction::setMqttConfig(const char* server, uint16_t port, 
+                                           const char* username, const char* password) {
+    if (!server || strlen(server) >= sizeof(mqttServer)) return reject("MQTT broker");
+    if (!username || strlen(username) >= sizeof(mqttUsername)) return reject("MQTT username");
+    if (password && strlen(password) >= sizeof(mqttPassword)) return reject("MQTT password");
+
+    strlcpy(mqttServer, server, sizeof(mqttServer));
+    mqttPort = port;
+    strlcpy(mqttUsername, username, sizeof(mqttUsername));
+    strlcpy(mqttPassword, password ? password : "", sizeof(mqttPassword));
+    staged |= ConfigCache::dirtyBit(ConfigKey::MQTT);
+    return true;
+}
+
+bool PreferencesTransaction::setAutoScanEnabled(bool enabled) {
+    autoScan = enabled;
+    staged |= ConfigCache::dirtyBit(ConfigKey::AUTO_SCAN);
+    return true;
+}
+
+bool PreferencesTransaction::setScanInterval(uint32_t seconds) {
+    if (seconds < MIN_SCAN_INTERVAL || seconds > MAX_SCAN_INTERVAL) return reject("scan interval");
+
+    scanInterval = seconds;
+    staged |= ConfigCache::dirtyBit(ConfigKey::SCAN_INTERVAL);
+    return true;
+}
+
+bool PreferencesTransaction::setDisplaySensor(const uint8_t* address) {
+    if (!address) return reject("display sensor");
+
+    memcpy(displaySensor, address, 8);
+    staged |= ConfigCache::dirtyBit(ConfigKey::DISPLAY_SENSOR);
+    return true;
+}
+
+bool PreferencesTransaction::setRelayName(uint8_t relayId, const char* name) {
+    if (relayId >= ConfigCache::RELAY_COUNT || !name || 
+        strlen(name) >= MAX_SENSOR_NAME_LENGTH) {
+        return reject("relay name");
+    }
+
+    strlcpy(relayNames[relayId], name, sizeof(relayNames[relayId]));
+    relayMask |= 1 << relayId;
+    staged |= ConfigCache::dirtyBit(ConfigKey::RELAY_NAME);
+    return true;
+}
+
+bool PreferencesTransaction::setSensorName(const uint8_t* address, const char* name) {
+    if (!address || !name || strlen(name) >= MAX_SENSOR_NAME_LENGTH) return reject("sensor name");
+
+    SensorChange* change = sensorChange(address);
+    if (!change) return reject("too many sensors");
+    strlcpy(change->name, name, sizeof(change->name));
+    change->fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_NAME);
+    return true;
+}
+
+bool PreferencesTransaction::setSensorResolution(const uint8_t* address, uint8_t bits) {
+    if (!address || bits < MIN_SENSOR_RESOLUTION || bits > MAX_SENSOR_RESOLUTION) {
+        return reject("sensor resolution");
+    }
+
+    SensorChange* change = sensorChange(address);
+    if (!change) return reject("too many sensors");
+    change->resolution = bits;
+    change->fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_RESOLUTION);
+    return true;
+}
+
+bool PreferencesTransaction::setSensorFilter(const uint8_t* address, FilterType type) {
+    if (!address || type >= FilterType::COUNT) return reject("sensor filter");
+
+    SensorChange* change = sensorChange(address);
+    if (!change) return reject("too many sensors");
+    change->filter = static_cast<uint8_t>(type);
+    change->fields |= ConfigCache::dirtyBit(ConfigKey::SENSOR_FILTER);
+    return true;
+}
+
+bool PreferencesTransaction::commit() {
+    return PreferencesManager::commit(*this);
+}
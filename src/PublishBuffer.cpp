@@ -0,0 +1,91 @@
+// src/PublishBuffer.cpp
+#include "PublishBuffer.h"
+#include "Logger.h"
+
+bool PublishBuffer::init() {
+    if (!mutex) {
+        mutex = xSemaphoreCreateMutex();
+        if (!mutex) {
+            Logger::error("Failed to create publish buffer mutex");
+            return false;
+        }
+    }
+    return true;
+}
+
+void PublishBuffer::trackDepthLocked() {
+    counters.depth = depthLocked();
+    if (counters.depth > counters.maxDepth) {
+        counters.maxDepth = counters.depth;
+    }
+}
+
+bool PublishBuffer::post(uint8_t key, const TaskMessage& msg) {
+    if (!mutex || key >= MAX_KEYS) return false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+
+    if (pending[key]) {
+        counters.coalesced++;
+    } else {
+        pending[key] = true;
+        pendingCount++;
+    }
+    latest[key] = msg;
+    counters.posted++;
+    trackDepthLocked();
+
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+bool PublishBuffer::pushEvent(const TaskMessage& msg) {
+    if (!mutex) return false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+
+    bool accepted = eventCount < EVENT_CAPACITY;
+    if (accepted) {
+        events[(eventHead + eventCount) % EVENT_CAPACITY] = msg;
+        eventCount++;
+        counters.posted++;
+        trackDepthLocked();
+    } else {
+        counters.dropped++;
+    }
+
+    xSemaphoreGive(mutex);
+    return accepted;
+}
+
+bool PublishBuffer::take(TaskMessage& msg) {
+    if (!mutex) return false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+
+    bool found = false;
+    for (uint8_t key = 0; key < MAX_KEYS && !found; key++) {
+        if (pending[key]) {
+            msg = latest[key];
+            pending[key] = false;
+            pendingCount--;
+            found = true;
+        }
+    }
+    if (!found && eventCount > 0) {
+        msg = events[eventHead];
+        eventHead = (eventHead + 1) % EVENT_CAPACITY;
+        eventCount--;
+        found = true;
+    }
+    counters.depth = depthLocked();
+
+    xSemaphoreGive(mutex);
+    return found;
+}
+
+PublishBuffer::Counters PublishBuffer::getCounters() {
+    Counters copy = {};
+    if (mutex && xSemaphoreTake(mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        copy = counters;
+        xSemaphoreGive(mutex);
+    }
+    return copy;
+}
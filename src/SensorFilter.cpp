@@ -0,0 +1,115 @@
+// src/SensorFilter.cpp
+#include "SensorFilter.h"
+#include <cmath>
+#include <cstring>
+
+void SensorFilter::configure(FilterType newType) {
+    if (newType >= FilterType::COUNT) newType = FilterType::NONE;
+    if (newType == type) return;
+
+    type = newType;
+    reset();
+}
+
+void SensorFilter::reset() {
+    samples = 0;
+    memset(&state, 0, sizeof(state));
+}
+
+int16_t SensorFilter::update(int16_t sample) {
+    int16_t out;
+    switch (type) {
+        case FilterType::MEDIAN: out = updateMedian(sample); break;
+        case FilterType::EMA:    out = updateEma(sample); break;
+        case FilterType::KALMAN: out = updateKalman(sample); break;
+        default:                 out = sample; break;
+    }
+    if (samples < UINT8_MAX) samples++;
+    return out;
+}
+
+// Median of the last MEDIAN_WINDOW samples, or of what has arrived so far.
+// A single spike never reaches the output once three samples are in.
+int16_t SensorFilter::updateMedian(int16_t sample) {
+    auto& m = state.median;
+    m.window[m.head] = sample;
+    m.head = (m.head + 1) % MEDIAN_WINDOW;
+
+    uint8_t n = (samples + 1 < MEDIAN_WINDOW) ? samples + 1 : MEDIAN_WINDOW;
+    int16_t sorted[MEDIAN_WINDOW];
+    for (uint8_t i = 0; i < n; i++) {
+        int16_t v = m.window[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    return sorted[n / 2];
+}
+
+// Accumulator carries four extra fraction bits so small steps are not lost
+int16_t SensorFilter::updateEma(int16_t sample) {
+    auto& e = state.ema;
+    int32_t scaled = (int32_t)sample << 4;
+    if (samples == 0) {
+        e.acc = scaled;
+    } else {
+        e.acc += (scaled - e.acc) / (1 << EMA_SHIFT);
+    }
+    return (int16_t)((e.acc + (e.acc >= 0 ? 8 : -8)) / 16);
+}
+
+// Samples whose innovation exceeds the gate are treated as spikes and dropped.
+// A run of rejected samples means the temperature really moved, so the filter
+// restarts from the new value instead of lagging behind it.
+int16_t SensorFilter::updateKalman(int16_t sample) {
+    auto& k = state.kalman;
+    if (samples == 0) {
+        k.estimate = sample;
+        k.variance = KALMAN_MEASUREMENT_NOISE;
+        k.rejects = 0;
+        return sample;
+    }
+
+    k.variance += KALMAN_PROCESS_NOISE;
+    float innovation = sample - k.estimate;
+    float gate = fmaxf(KALMAN_GATE_SIGMA * sqrtf(k.variance + KALMAN_MEASUREMENT_NOISE),
+                       KALMAN_MIN_GATE);
+
+    if (fabsf(innovation) > gate) {
+        if (++k.rejects <= KALMAN_MAX_REJECTS) {
+            return (int16_t)lroundf(k.estimate);
+        }
+        k.estimate = sample;
+        k.variance = KALMAN_MEASUREMENT_NOISE;
+        k.rejects = 0;
+        return sample;
+    }
+
+    k.rejects = 0;
+    float gain = k.variance / (k.variance + KALMAN_MEASUREMENT_NOISE);
+    k.estimate += gain * innovation;
+    k.variance *= 1.0f - gain;
+    return (int16_t)lroundf(k.estimate);
+}
+
+const char* SensorFilter::typeName(FilterType type) {
+    switch (type) {
+        case FilterType::MEDIAN: return "median";
+        case FilterType::EMA:    return "ema";
+        case FilterType::KALMAN: return "kalman";
+        default:                 return "none";
+    }
+}
+
+bool SensorFilter::parseType(const char* name, FilterType& out) {
+    if (!name) return false;
+    for (uint8_t t = 0; t < static_cast<uint8_t>(FilterType::COUNT); t++) {
+        if (strcmp(name, typeName(static_cast<FilterType>(t))) == 0) {
+            out = static_cast<FilterType>(t);
+            return true;
+        }
+    }
+    return false;
+}
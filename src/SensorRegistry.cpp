@@ -0,0 +1,205 @@
+// src/SensorRegistry.cpp
+#include "SensorRegistry.h"
+#include "Logger.h"
+#include "PreferencesManager.h"
+
+// Static member initialization
+SensorRegistry::Snapshot SensorRegistry::buffers[2];
+std::atomic<uint32_t> SensorRegistry::generation{0};
+SemaphoreHandle_t SensorRegistry::writerMutex = nullptr;
+char SensorRegistry::names[MAX_TOTAL_SENSORS][MAX_SENSOR_NAME_LENGTH] = {};
+uint64_t SensorRegistry::nameKeys[MAX_TOTAL_SENSORS] = {};
+SemaphoreHandle_t SensorRegistry::namesMutex = nullptr;
+
+void SensorRegistry::init() {
+    if (!writerMutex) {
+        writerMutex = xSemaphoreCreateMutex();
+        if (!writerMutex) {
+            Logger::error("Failed to create sensor registry mutex");
+        }
+    }
+    if (!namesMutex) {
+        namesMutex = xSemaphoreCreateMutex();
+        if (!namesMutex) {
+            Logger::error("Failed to create sensor name mutex");
+        }
+        PreferencesManager::subscribe(onConfigChanged);
+    }
+}
+
+// Keep the name cache in step with renames from any source
+void SensorRegistry::onConfigChanged(ConfigKey key, const uint8_t* address) {
+    if (key == ConfigKey::SENSOR_NAME && address) {
+        setSensorName(address, PreferencesManager::getSensorName(address).c_str());
+    }
+}
+
+// Replace the contents of one bus. Sensors still present keep their slot,
+// sensors that disappeared release theirs. Bus tasks serialize on writerMutex;
+// readers are never blocked.
+void SensorRegistry::update(uint8_t bus, const SensorTable& table, 
+                            const KnownDeviceCache* known) {
+    if (!writerMutex || bus >= ONE_WIRE_BUS_COUNT) return;
+    
+    if (xSemaphoreTake(writerMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        Logger::error("Failed to acquire mutex in SensorRegistry::update");
+        return;
+    }
+    
+    uint32_t current = generation.load(std::memory_order_relaxed);
+    const Snapshot& front = buffers[current & 1];
+    Snapshot& back = buffers[(current + 1) & 1];
+    
+    // Mark the back buffer as being written before touching it
+    back.seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    back.count = front.count;
+    memcpy(back.slotUsed, front.slotUsed, sizeof(back.slotUsed));
+    memcpy(back.slots, front.slots, sizeof(back.slots));
+    back.index = front.index;
+    
+    bool present[MAX_TOTAL_SENSORS] = {};
+    
+    for (uint8_t i = 0; i < table.count; i++) {
+        uint64_t key = romKey(table.address[i]);
+        int slot = back.index.find(key);
+        
+        if (slot == NO_SLOT) {
+            slot = allocateSlot(back);
+            if (slot == NO_SLOT) {
+                Logger::error("Sensor registry full");
+                break;
+            }
+            back.slotUsed[slot] = true;
+            back.index.insert(key, slot);
+            loadName(slot, table.address[i], known);
+        }
+        
+        table.toSensor(i, bus, back.slots[slot]);
+        present[slot] = true;
+    }
+    
+    // Release slots of this bus whose sensor is gone
+    for (size_t slot = 0; slot < MAX_TOTAL_SENSORS; slot++) {
+        if (back.slotUsed[slot] && back.slots[slot].bus == bus && !present[slot]) {
+            back.index.erase(romKey(back.slots[slot].address));
+            back.slotUsed[slot] = false;
+        }
+    }
+    back.count = back.index.size();
+    
+    back.seq.fetch_add(1, std::memory_order_release);
+    generation.store(current + 1, std::memory_order_release);
+    
+    xSemaphoreGive(writerMutex);
+}
+
+int SensorRegistry::allocateSlot(const Snapshot& snapshot) {
+    for (size_t slot = 0; slot < MAX_TOTAL_SENSORS; slot++) {
+        if (!snapshot.slotUsed[slot]) return slot;
+    }
+    return NO_SLOT;
+}
+
+// Copy of all sensors in slot order
+std::vector<TemperatureSensor> SensorRegistry::getSensors() {
+    std::vector<TemperatureSensor> merged;
+    merged.reserve(MAX_TOTAL_SENSORS);
+    
+    readSnapshot([&merged](const Snapshot& snapshot) {
+        merged.clear();
+        for (size_t slot = 0; slot < MAX_TOTAL_SENSORS; slot++) {
+            if (snapshot.slotUsed[slot]) merged.push_back(snapshot.slots[slot]);
+        }
+    });
+    return merged;
+}
+
+bool SensorRegistry::findSensor(const uint8_t* address, TemperatureSensor& sensor) {
+    if (!address) return false;
+    
+    uint64_t key = romKey(address);
+    bool found = false;
+    readSnapshot([&](const Snapshot& snapshot) {
+        int slot = snapshot.index.find(key);
+        found = slot != NO_SLOT;
+        if (found) sensor = snapshot.slots[slot];
+    });
+    return found;
+}
+
+int SensorRegistry::findSlot(const uint8_t* address) {
+    if (!address) return NO_SLOT;
+    
+    uint64_t key = romKey(address);
+    int slot = NO_SLOT;
+    readSnapshot([&](const Snapshot& snapshot) {
+        slot = snapshot.index.find(key);
+    });
+    return slot;
+}
+
+bool SensorRegistry::getSensor(int slot, TemperatureSensor& sensor) {
+    if (slot < 0 || slot >= (int)MAX_TOTAL_SENSORS) return false;
+    
+    bool found = false;
+    readSnapshot([&](const Snapshot& snapshot) {
+        found = snapshot.slotUsed[slot];
+        if (found) sensor = snapshot.slots[slot];
+    });
+    return found;
+}
+
+size_t SensorRegistry::getSensorCount() {
+    size_t count = 0;
+    readSnapshot([&count](const Snapshot& snapshot) {
+        count = snapshot.count;
+    });
+    return count;
+}
+
+// Cache the stored name of a sensor that just got a slot. Runs with
+// writerMutex held, so it only reads the lock-free preferences cache and
+// never waits for a flush.
+void SensorRegistry::loadName(int slot, const uint8_t* address, const KnownDeviceCache* known) {
+    const KnownDeviceCache::Entry* entry = known ? known->find(address) : nullptr;
+    String name = entry ? String(entry->name) : PreferencesManager::getSensorName(address);
+    
+    if (namesMutex && xSemaphoreTake(namesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        strlcpy(names[slot], name.c_str(), MAX_SENSOR_NAME_LENGTH);
+        nameKeys[slot] = romKey(address);
+        xSemaphoreGive(namesMutex);
+    }
+}
+
+// Cached name, falling back to storage for sensors that are not on a bus
+String SensorRegistry::getSensorName(const uint8_t* address) {
+    if (!address) return "";
+    
+    uint64_t key = romKey(address);
+    int slot = findSlot(address);
+    if (slot != NO_SLOT && namesMutex && 
+        xSemaphoreTake(namesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        String name;
+        bool cached = nameKeys[slot] == key;
+        if (cached) name = names[slot];
+        xSemaphoreGive(namesMutex);
+        if (cached) return name;
+    }
+    return PreferencesManager::getSensorName(address);
+}
+
+// Keep the cache in step after a name was saved
+void SensorRegistry::setSensorName(const uint8_t* address, const char* name) {
+    if (!address || !name) return;
+    
+    int slot = findSlot(address);
+    if (slot == NO_SLOT || !namesMutex) return;
+    
+    if (xSemaphoreTake(namesMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        strlcpy(names[slot], name, MAX_SENSOR_NAME_LENGTH);
+        nameKeys[slot] = romKey(address);
+        xSemaphoreGive(namesMutex);
+    }
+}
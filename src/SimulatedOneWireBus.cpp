@@ -0,0 +1,377 @@
+// src/SimulatedOneWireBus.cpp
+#include "SimulatedOneWireBus.h"
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace {
+constexpr uint8_t CMD_CONVERT_T = 0x44;
+constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+constexpr uint8_t CMD_COPY_SCRATCHPAD = 0x48;
+constexpr uint8_t CMD_RECALL_EEPROM = 0xB8;
+constexpr uint8_t CMD_READ_POWER_SUPPLY = 0xB4;
+}
+
+SimulatedOneWireBus::SimulatedOneWireBus(uint32_t seed, Clock clock)
+    : state(State::IDLE)
+    , buffer{}
+    , bufferPos(0)
+    , searchRom{}
+    , lastDiscrepancy(0)
+    , lastDevice(false)
+    , faults{}
+    , counters{}
+    , clock(clock)
+    , rng(seed ? seed : 1) {
+}
+
+uint32_t SimulatedOneWireBus::now() const {
+    if (clock) return clock();
+#ifdef ARDUINO
+    return millis();
+#else
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - start).count();
+#endif
+}
+
+// xorshift32; good enough for serial numbers and fault placement
+uint32_t SimulatedOneWireBus::nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+bool SimulatedOneWireBus::chance(float probability) {
+    if (probability <= 0.0f) return false;
+    return (nextRandom() & 0xFFFFFF) < (uint32_t)(probability * 0x1000000);
+}
+
+// New device with a random serial number, powered up with EEPROM defaults
+size_t SimulatedOneWireBus::addDevice(int16_t temperatureRaw, bool parasite) {
+    Device device = {};
+    device.rom[0] = 0x28;
+    for (uint8_t i = 1; i < 7; i++) {
+        device.rom[i] = (uint8_t)nextRandom();
+    }
+    device.rom[7] = crc8(device.rom, 7);
+    device.temperature = temperatureRaw;
+    device.reading = RAW_POWER_ON;
+    device.eepromTh = 75;
+    device.eepromTl = 70;
+    device.eepromConfig = 0x7F;
+    device.th = device.eepromTh;
+    device.tl = device.eepromTl;
+    device.config = device.eepromConfig;
+    device.parasite = parasite;
+    device.present = true;
+
+    devices.push_back(device);
+    return devices.size() - 1;
+}
+
+// Spread readings over a few degrees so sensors are distinguishable
+void SimulatedOneWireBus::populate(size_t count, int16_t baseRaw) {
+    for (size_t i = 0; i < count; i++) {
+        addDevice(baseRaw + (int16_t)((i % 32) * 4));
+    }
+}
+
+bool SimulatedOneWireBus::removeDevice(const uint8_t* rom) {
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (memcmp(devices[i].rom, rom, 8) == 0) {
+            devices.erase(devices.begin() + i);
+            selected.clear();
+            return true;
+        }
+    }
+    return false;
+}
+
+// An unplugged device loses power and comes back with its EEPROM settings
+void SimulatedOneWireBus::setPresent(size_t index, bool present) {
+    if (index >= devices.size()) return;
+    Device& device = devices[index];
+    if (!device.present && present) {
+        device.reading = RAW_POWER_ON;
+        device.th = device.eepromTh;
+        device.tl = device.eepromTl;
+        device.config = device.eepromConfig;
+        device.converting = false;
+        device.alarm = false;
+    }
+    device.present = present;
+}
+
+void SimulatedOneWireBus::setTemperature(size_t index, int16_t temperatureRaw) {
+    if (index < devices.size()) {
+        devices[index].temperature = temperatureRaw;
+    }
+}
+
+uint8_t SimulatedOneWireBus::resolutionBits(const Device& device) const {
+    return 9 + ((device.config >> 5) & 0x03);
+}
+
+// Typical conversion time is about 80% of the datasheet maximum
+void SimulatedOneWireBus::startConversion(Device& device) {
+    uint32_t maxTime = 750 >> (12 - resolutionBits(device));
+    device.conversionTime = maxTime * 4 / 5;
+    device.conversionStart = now();
+    device.converting = true;
+    counters.conversions++;
+}
+
+// Latch finished conversions: the undefined low bits read as zero and the
+// alarm flag compares the integer part against TH/TL
+void SimulatedOneWireBus::finishConversions() {
+    uint32_t t = now();
+    for (Device& device : devices) {
+        if (!device.converting || t - device.conversionStart < device.conversionTime) continue;
+
+        uint8_t dropBits = 12 - resolutionBits(device);
+        device.reading = (int16_t)(device.temperature & ~((1 << dropBits) - 1));
+        int8_t whole = (int8_t)(device.reading >> 4);
+        device.alarm = whole >= (int8_t)device.th || whole <= (int8_t)device.tl;
+        device.converting = false;
+    }
+}
+
+void SimulatedOneWireBus::buildScratchpad(const Device& device, uint8_t* out) const {
+    out[0] = (uint8_t)(device.reading & 0xFF);
+    out[1] = (uint8_t)((uint16_t)device.reading >> 8);
+    out[2] = device.th;
+    out[3] = device.tl;
+    out[4] = device.config;
+    out[5] = 0xFF;
+    out[6] = 0x0C;
+    out[7] = 0x10;
+    out[8] = crc8(out, 8);
+}
+
+bool SimulatedOneWireBus::reset() {
+    counters.resets++;
+    counters.busTimeUs += RESET_US;
+    finishConversions();
+
+    state = State::IDLE;
+    selected.clear();
+    bool presence = false;
+    for (Device& device : devices) {
+        device.droppedOut = device.present && chance(faults.dropoutRate);
+        if (device.droppedOut) counters.dropouts++;
+        if (device.present && !device.droppedOut) presence = true;
+    }
+    return presence;
+}
+
+void SimulatedOneWireBus::select(const uint8_t* rom) {
+    counters.bytesWritten += 9;
+    counters.busTimeUs += 9 * 8 * SLOT_US;
+    selected.clear();
+    for (size_t i = 0; i < devices.size(); i++) {
+        const Device& device = devices[i];
+        if (device.present && !device.droppedOut && memcmp(device.rom, rom, 8) == 0) {
+            selected.push_back(i);
+        }
+    }
+    state = State::FUNCTION;
+}
+
+void SimulatedOneWireBus::skip() {
+    counters.bytesWritten++;
+    counters.busTimeUs += 8 * SLOT_US;
+    selected.clear();
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i].present && !devices[i].droppedOut) {
+            selected.push_back(i);
+        }
+    }
+    state = State::FUNCTION;
+}
+
+void SimulatedOneWireBus::write(uint8_t value, bool power) {
+    (void)power;
+    counters.bytesWritten++;
+    counters.busTimeUs += 8 * SLOT_US;
+
+    if (state == State::WRITE_SCRATCHPAD) {
+        for (size_t i : selected) {
+            Device& device = devices[i];
+            if (bufferPos == 0) device.th = value;
+            else if (bufferPos == 1) device.tl = value;
+            else if (bufferPos == 2) device.config = (value & 0x60) | 0x1F;
+        }
+        bufferPos++;
+        return;
+    }
+
+    if (state != State::FUNCTION) return;
+
+    switch (value) {
+        case CMD_CONVERT_T:
+            for (size_t i : selected) startConversion(devices[i]);
+            state = State::CONVERTING;
+            break;
+
+        case CMD_READ_SCRATCHPAD: {
+            // Several devices answering at once give the wired-AND of their data
+            memset(buffer, 0xFF, sizeof(buffer));
+            for (size_t i : selected) {
+                uint8_t data[SCRATCHPAD_SIZE];
+                buildScratchpad(devices[i], data);
+                for (uint8_t b = 0; b < SCRATCHPAD_SIZE; b++) buffer[b] &= data[b];
+            }
+            if (!selected.empty() && chance(faults.crcErrorRate)) {
+                uint32_t r = nextRandom();
+                buffer[r % SCRATCHPAD_SIZE] ^= (uint8_t)(1 << ((r >> 8) & 7));
+                counters.crcErrorsInjected++;
+            }
+            bufferPos = 0;
+            state = State::READ_SCRATCHPAD;
+            break;
+        }
+
+        case CMD_WRITE_SCRATCHPAD:
+            bufferPos = 0;
+            state = State::WRITE_SCRATCHPAD;
+            break;
+
+        case CMD_COPY_SCRATCHPAD:
+            for (size_t i : selected) {
+                Device& device = devices[i];
+                device.eepromTh = device.th;
+                device.eepromTl = device.tl;
+                device.eepromConfig = device.config;
+            }
+            state = State::IDLE;
+            break;
+
+        case CMD_RECALL_EEPROM:
+            for (size_t i : selected) {
+                Device& device = devices[i];
+                device.th = device.eepromTh;
+                device.tl = device.eepromTl;
+                device.config = device.eepromConfig;
+            }
+            state = State::IDLE;
+            break;
+
+        case CMD_READ_POWER_SUPPLY:
+            state = State::READ_POWER;
+            break;
+
+        default:
+            state = State::IDLE;
+            break;
+    }
+}
+
+uint8_t SimulatedOneWireBus::read() {
+    counters.bytesRead++;
+    counters.busTimeUs += 8 * SLOT_US;
+
+    if (state == State::READ_SCRATCHPAD && bufferPos < SCRATCHPAD_SIZE) {
+        return buffer[bufferPos++];
+    }
+    return 0xFF;
+}
+
+// Read slots are held low by a converting device and by parasite-powered
+// devices answering READ POWER SUPPLY
+uint8_t SimulatedOneWireBus::readBit() {
+    counters.bitsRead++;
+    counters.busTimeUs += SLOT_US;
+
+    if (state == State::CONVERTING) {
+        finishConversions();
+        for (size_t i : selected) {
+            if (devices[i].converting) return 0;
+        }
+    } else if (state == State::READ_POWER) {
+        for (size_t i : selected) {
+            if (devices[i].parasite) return 0;
+        }
+    }
+    return 1;
+}
+
+void SimulatedOneWireBus::resetSearch() {
+    memset(searchRom, 0, sizeof(searchRom));
+    lastDiscrepancy = 0;
+    lastDevice = false;
+}
+
+// One step of the 1-Wire search: at every bit where participating devices
+// disagree, take the branch chosen by the previous discrepancy
+bool SimulatedOneWireBus::search(uint8_t* rom, bool alarmOnly) {
+    if (lastDevice || !reset()) {
+        resetSearch();
+        return false;
+    }
+    counters.searches++;
+    counters.bytesWritten++;
+    counters.busTimeUs += (8 + 64 * 3) * SLOT_US;
+
+    std::vector<size_t>& candidates = searchCandidates;
+    candidates.clear();
+    for (size_t i = 0; i < devices.size(); i++) {
+        const Device& device = devices[i];
+        if (device.present && !device.droppedOut && (!alarmOnly || device.alarm)) {
+            candidates.push_back(i);
+        }
+    }
+
+    uint8_t lastZero = 0;
+    for (uint8_t bitNumber = 1; bitNumber <= 64; bitNumber++) {
+        uint8_t byteIndex = (bitNumber - 1) / 8;
+        uint8_t mask = 1 << ((bitNumber - 1) % 8);
+
+        bool anyZero = false;
+        bool anyOne = false;
+        for (size_t i : candidates) {
+            if (devices[i].rom[byteIndex] & mask) anyOne = true;
+            else anyZero = true;
+        }
+        if (!anyZero && !anyOne) {
+            resetSearch();
+            return false;
+        }
+
+        bool direction;
+        if (anyZero && anyOne) {
+            if (bitNumber < lastDiscrepancy) {
+                direction = searchRom[byteIndex] & mask;
+            } else {
+                direction = bitNumber == lastDiscrepancy;
+            }
+            if (!direction) lastZero = bitNumber;
+        } else {
+            direction = anyOne;
+        }
+
+        if (direction) searchRom[byteIndex] |= mask;
+        else searchRom[byteIndex] &= ~mask;
+
+        size_t kept = 0;
+        for (size_t i : candidates) {
+            if (((devices[i].rom[byteIndex] & mask) != 0) == direction) {
+                candidates[kept++] = i;
+            }
+        }
+        candidates.resize(kept);
+    }
+
+    lastDiscrepancy = lastZero;
+    lastDevice = lastDiscrepancy == 0;
+    memcpy(rom, searchRom, 8);
+    state = State::IDLE;
+    return true;
+}
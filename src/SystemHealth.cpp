@@ -1,11 +1,17 @@
 // src/SystemHealth.cpp
 #include "SystemHealth.h"
 #include "Logger.h"
+#include "SensorRegistry.h"
+#include "NetworkTask.h"
+#include "OneWireTask.h"
+#include <ArduinoJson.h>
 #include <esp_heap_caps.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 SystemHealth::Metrics SystemHealth::metrics;
+BusTiming SystemHealth::busTiming[ONE_WIRE_BUS_COUNT] = {};
+CycleStats SystemHealth::lastCycle[ONE_WIRE_BUS_COUNT] = {};
 SemaphoreHandle_t SystemHealth::metricsMutex = nullptr;
 uint32_t SystemHealth::lastUpdateTime = 0;
 
@@ -46,19 +52,28 @@ void SystemHealth::updateHeapMetrics() {
 
 void SystemHealth::updateStackMetrics() {
     // Get stack high water marks for key tasks using task handles
-    TaskHandle_t oneWireHandle = xTaskGetHandle("OneWireTask");
     TaskHandle_t networkHandle = xTaskGetHandle("NetworkTask");
     TaskHandle_t controlHandle = xTaskGetHandle("ControlTask");
     
-    if (oneWireHandle) {
+    // One OneWire task per bus; report the tightest of them
+    UBaseType_t oneWireMark = UINT32_MAX;
+    for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+        char taskName[16];
+        snprintf(taskName, sizeof(taskName), "OneWireTask%u", bus);
+        TaskHandle_t oneWireHandle = xTaskGetHandle(taskName);
+        if (!oneWireHandle) continue;
+        
         UBaseType_t stackMark = uxTaskGetStackHighWaterMark(oneWireHandle);
-        metrics.maxStackUsage1Wire = stackMark;
+        if (stackMark < oneWireMark) oneWireMark = stackMark;
         
         // Log warning if stack space is getting low
         if (stackMark < 512) {
-            Logger::warning("Low stack in OneWireTask: " + String(stackMark) + " words remaining");
+            Logger::warning("Low stack in " + String(taskName) + ": " + String(stackMark) + " words remaining");
         }
     }
+    if (oneWireMark != UINT32_MAX) {
+        metrics.maxStackUsage1Wire = oneWireMark;
+    }
     
     if (networkHandle) {
         UBaseType_t stackMark = uxTaskGetStackHighWaterMark(networkHandle);
@@ -102,6 +117,7 @@ void SystemHealth::updateTaskMetrics() {
 
 String SystemHealth::getStatusReport() {
     String report;
+    PublishBuffer::Counters publish = NetworkTask::getPublishCounters();
     
     if (xSemaphoreTake(metricsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         report = "System Health Report\n"
@@ -116,7 +132,40 @@ String SystemHealth::getStatusReport() {
                  "  Watchdog Near Misses: " + String(metrics.watchdogNearMisses) + "\n"
                  "  MQTT Reconnections: " + String(metrics.mqttReconnections) + "\n"
                  "  HTTP Overflows: " + String(metrics.httpOverflowCount) + "\n"
-                 "  OneWire Errors: " + String(metrics.oneWireErrors);
+                 "  OneWire Errors: " + String(metrics.oneWireErrors) + "\n"
+                 "Publish Buffer:\n"
+                 "  Posted: " + String(publish.posted) + "\n"
+                 "  Coalesced: " + String(publish.coalesced) + "\n"
+                 "  Dropped: " + String(publish.dropped) + "\n"
+                 "  Depth: " + String(publish.depth) + " (max " + String(publish.maxDepth) + ")\n"
+                 "OneWire Bus Timing (mean/max us, preempted passes):";
+        
+        for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+            report += "\n  Bus " + String(bus) + ":";
+            for (uint8_t op = 0; op < static_cast<uint8_t>(BusOperation::COUNT); op++) {
+                const LatencyHistogram& hist = busTiming[bus].ops[op];
+                report += " " + String(BusTiming::operationName(static_cast<BusOperation>(op))) +
+                          "=" + String(hist.meanUs()) + "/" + String(hist.maxUs);
+            }
+            report += busTiming[bus].preemptionMeasured ? 
+                " preempted=" + String(busTiming[bus].preemptedPasses) + "/" + String(busTiming[bus].passes) :
+                String(" preempted=unavailable");
+        }
+        
+        report += "\nOneWire Last Cycle (resets/slots/bus us/lock us/crc errors/in band):";
+        for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+            const CycleStats& cycle = lastCycle[bus];
+            report += "\n  Bus " + String(bus) + ": " + String(cycle.resets) + "/" + 
+                      String(cycle.bitSlots) + "/" + String(cycle.busTimeUs) + "/" + 
+                      String(cycle.lockTimeUs) + "/" + String(cycle.crcErrors) + "/" + 
+                      String(cycle.inBand);
+        }
+        
+        report += "\nTimers (runs/late/skipped/max late ms):";
+        appendTimerReport(report, "Network", NetworkTask::getTimers());
+        for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+            appendTimerReport(report, ("OneWire" + String(bus)).c_str(), OneWireTask::getTimers(bus));
+        }
         
         xSemaphoreGive(metricsMutex);
     }
@@ -124,6 +173,17 @@ String SystemHealth::getStatusReport() {
     return report;
 }
 
+// Counters are written by the owning task without a lock; a report may catch
+// one of them mid-update, which only matters by a single count
+void SystemHealth::appendTimerReport(String& report, const char* owner, const TimerWheel& timers) {
+    report += "\n  " + String(owner) + ":";
+    for (uint8_t id = 0; id < timers.getCount(); id++) {
+        const TimerWheel::Stats& stats = timers.getStats(id);
+        report += " " + String(timers.getName(id)) + "=" + String(stats.runs) + "/" +
+                  String(stats.lateRuns) + "/" + String(stats.skipped) + "/" + String(stats.maxLateMs);
+    }
+}
+
 void SystemHealth::recordWatchdogNearMiss() {
     if (xSemaphoreTake(metricsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         metrics.watchdogNearMisses++;
@@ -131,4 +191,99 @@ void SystemHealth::recordWatchdogNearMiss() {
                        String(metrics.watchdogNearMisses));
         xSemaphoreGive(metricsMutex);
     }
-}
\ No newline at end of file
+}
+
+void SystemHealth::updateBusTiming(uint8_t bus, const BusTiming& timing, const CycleStats& cycle) {
+    if (!metricsMutex || bus >= ONE_WIRE_BUS_COUNT) return;
+    
+    if (xSemaphoreTake(metricsMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        busTiming[bus] = timing;
+        lastCycle[bus] = cycle;
+        xSemaphoreGive(metricsMutex);
+    }
+}
+
+// Histograms per bus and operation plus per-sensor read error rates. Buckets are
+// log2 microseconds and trailing empty buckets are omitted. Empty if the
+// document overflowed.
+String SystemHealth::getBusStatsJson() {
+    const auto sensorList = SensorRegistry::getSensors();
+    constexpr size_t OPERATIONS = static_cast<size_t>(BusOperation::COUNT);
+    
+    // Per bus: its object, the last cycle and one object and bucket array per
+    // operation. Per sensor: the object plus the copied address.
+    size_t requiredSize = JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(ONE_WIRE_BUS_COUNT);
+    requiredSize += ONE_WIRE_BUS_COUNT * (JSON_OBJECT_SIZE(6) + JSON_OBJECT_SIZE(6) + 
+                                          JSON_OBJECT_SIZE(OPERATIONS) +
+                                          OPERATIONS * (JSON_OBJECT_SIZE(4) + 
+                                                        JSON_ARRAY_SIZE(LatencyHistogram::BUCKETS)));
+    requiredSize += JSON_ARRAY_SIZE(sensorList.size()) + sensorList.size() * (JSON_OBJECT_SIZE(5) + 17);
+    
+    DynamicJsonDocument doc(requiredSize);
+    JsonArray buses = doc.createNestedArray("buses");
+    
+    if (xSemaphoreTake(metricsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (uint8_t bus = 0; bus < ONE_WIRE_BUS_COUNT; bus++) {
+            JsonObject busObj = buses.createNestedObject();
+            busObj["bus"] = bus;
+            
+            // Zero preempted passes only means something when measured
+            busObj["preemptionMeasured"] = busTiming[bus].preemptionMeasured;
+            busObj["passes"] = busTiming[bus].passes;
+            busObj["preemptedPasses"] = busTiming[bus].preemptedPasses;
+            
+            const CycleStats& cycle = lastCycle[bus];
+            JsonObject cycleObj = busObj.createNestedObject("lastCycle");
+            cycleObj["resets"] = cycle.resets;
+            cycleObj["bitSlots"] = cycle.bitSlots;
+            cycleObj["busTimeUs"] = cycle.busTimeUs;
+            cycleObj["lockTimeUs"] = cycle.lockTimeUs;
+            cycleObj["crcErrors"] = cycle.crcErrors;
+            cycleObj["inBand"] = cycle.inBand;
+            
+            JsonObject ops = busObj.createNestedObject("operations");
+            
+            for (uint8_t op = 0; op < static_cast<uint8_t>(BusOperation::COUNT); op++) {
+                const LatencyHistogram& hist = busTiming[bus].ops[op];
+                JsonObject opObj = ops.createNestedObject(
+                    BusTiming::operationName(static_cast<BusOperation>(op)));
+                opObj["count"] = hist.samples;
+                opObj["meanUs"] = hist.meanUs();
+                opObj["maxUs"] = hist.maxUs;
+                
+                uint8_t used = LatencyHistogram::BUCKETS;
+                while (used > 0 && hist.counts[used - 1] == 0) used--;
+                JsonArray buckets = opObj.createNestedArray("buckets");
+                for (uint8_t b = 0; b < used; b++) {
+                    buckets.add(hist.counts[b]);
+                }
+            }
+        }
+        xSemaphoreGive(metricsMutex);
+    }
+    
+    JsonArray sensors = doc.createNestedArray("sensors");
+    for (const auto& sensor : sensorList) {
+        JsonObject sensorObj = sensors.createNestedObject();
+        char address[17];
+        snprintf(address, sizeof(address), "%02X%02X%02X%02X%02X%02X%02X%02X",
+                 sensor.address[0], sensor.address[1], sensor.address[2], sensor.address[3],
+                 sensor.address[4], sensor.address[5], sensor.address[6], sensor.address[7]);
+        sensorObj["address"] = address;
+        sensorObj["bus"] = sensor.bus;
+        sensorObj["reads"] = sensor.readCount;
+        sensorObj["errors"] = sensor.errorCount;
+        sensorObj["errorRate"] = sensor.readCount ? 
+            static_cast<float>(sensor.errorCount) / sensor.readCount : 0.0f;
+    }
+    
+    // A truncated report must not be served
+    if (doc.overflowed()) {
+        Logger::error("Bus stats response does not fit in " + String(requiredSize) + " bytes");
+        return String();
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    return response;
+}
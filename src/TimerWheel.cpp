@@ -0,0 +1,112 @@
+// src/TimerWheel.cpp
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel()
+    : timers{}
+    , count(0)
+    , lastRun(0)
+    , hasRun(false) {
+    for (uint8_t& slot : slots) slot = INVALID;
+}
+
+uint8_t TimerWheel::add(const char* name, uint32_t periodMs, uint32_t slackMs) {
+    if (count >= MAX_TIMERS) return INVALID;
+
+    Timer& timer = timers[count];
+    timer.name = name;
+    timer.periodMs = periodMs;
+    timer.slackMs = slackMs;
+    timer.next = INVALID;
+    timer.armed = false;
+    return count++;
+}
+
+void TimerWheel::start(uint8_t id, uint32_t now, uint32_t delayMs) {
+    if (id >= count) return;
+    if (timers[id].armed) unlink(id);
+
+    timers[id].deadline = now + delayMs;
+    link(id);
+}
+
+void TimerWheel::stop(uint8_t id) {
+    if (id < count && timers[id].armed) unlink(id);
+}
+
+void TimerWheel::link(uint8_t id) {
+    uint8_t slot = slotOf(timers[id].deadline);
+    timers[id].next = slots[slot];
+    timers[id].armed = true;
+    slots[slot] = id;
+}
+
+void TimerWheel::unlink(uint8_t id) {
+    uint8_t* link = &slots[slotOf(timers[id].deadline)];
+    while (*link != INVALID && *link != id) {
+        link = &timers[*link].next;
+    }
+    if (*link == id) *link = timers[id].next;
+    timers[id].next = INVALID;
+    timers[id].armed = false;
+}
+
+// Account for one expiry and re-arm periodic timers
+void TimerWheel::expire(uint8_t id, uint32_t now) {
+    Timer& timer = timers[id];
+    uint32_t late = now - timer.deadline;
+
+    timer.stats.runs++;
+    if (late > timer.slackMs) timer.stats.lateRuns++;
+    if (late > timer.stats.maxLateMs) timer.stats.maxLateMs = late;
+
+    if (timer.periodMs == 0) return;
+
+    uint32_t missed = late / timer.periodMs;
+    timer.stats.skipped += missed;
+    timer.deadline += (missed + 1) * timer.periodMs;
+    link(id);
+}
+
+// Only the slots for the ticks since the last run are visited. A slot holds
+// every timer whose deadline hashes to it, including ones several turns of
+// the wheel away, so each entry is checked against the clock.
+uint32_t TimerWheel::runDue(uint32_t now) {
+    uint32_t firstTick = hasRun ? lastRun / TICK_MS : now / TICK_MS - (SLOT_COUNT - 1);
+    uint32_t ticks = now / TICK_MS - firstTick + 1;
+    if (ticks > SLOT_COUNT) ticks = SLOT_COUNT;
+    lastRun = now;
+    hasRun = true;
+
+    uint32_t due = 0;
+    for (uint32_t i = 0; i < ticks; i++) {
+        uint8_t slot = (firstTick + i) & (SLOT_COUNT - 1);
+        uint8_t id = slots[slot];
+        while (id != INVALID) {
+            uint8_t next = timers[id].next;
+            if ((int32_t)(now - timers[id].deadline) >= 0) {
+                unlink(id);
+                due |= bit(id);
+            }
+            id = next;
+        }
+    }
+
+    // Re-arm after the walk so a timer never lands in a slot still to be visited
+    for (uint8_t id = 0; id < count; id++) {
+        if (due & bit(id)) expire(id, now);
+    }
+    return due;
+}
+
+uint32_t TimerWheel::msUntilNext(uint32_t now, uint32_t maxWaitMs) const {
+    uint32_t wait = maxWaitMs;
+    for (uint8_t id = 0; id < count; id++) {
+        const Timer& timer = timers[id];
+        if (!timer.armed) continue;
+
+        int32_t remaining = (int32_t)(timer.deadline + timer.slackMs - now);
+        if (remaining <= 0) return 0;
+        if ((uint32_t)remaining < wait) wait = remaining;
+    }
+    return wait;
+}
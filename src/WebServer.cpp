@@ -1,10 +1,13 @@
 // src/WebServer.cpp
 #include "WebServer.h"
 #include "AuthManager.h"
+#include "SystemHealth.h"
+#include "PreferencesManager.h"
 #include <ArduinoJson.h>
 #include <AsyncJson.h>
 #include <SPIFFS.h>
 #include "DallasTemperature.h"  // For DEVICE_DISCONNECTED_C
+#include <algorithm>
 #include <map>
 #define DEBUG
 // Rate limiting implementation using a circular buffer for memory efficiency
@@ -46,10 +49,10 @@ public:
 // Static rate limiter instance
 static RateLimiter rateLimiter;
 
-WebServer::WebServer(OneWireManager& owManager) 
-    : server(80)
-    , oneWireManager(owManager)
-    , preferencesHandler(owManager) {
+std::atomic<uint32_t> WebServer::sensorsConfigVersion{0};
+
+WebServer::WebServer() 
+    : server(80) {
 }
 
 void WebServer::begin() {
@@ -64,6 +67,7 @@ void WebServer::begin() {
         file = root.openNextFile();
     }
 
+    PreferencesManager::subscribe(onConfigChanged);
     setupRoutes();
     server.begin();
     Logger::info("Web server started successfully");
@@ -113,6 +117,22 @@ void WebServer::setupRoutes() {
             handleSensorsRequest(request);
         });
 
+    server.on("/api/bus-stats", HTTP_GET, 
+        [this](AsyncWebServerRequest* request) {
+            Logger::debug("Handling /api/bus-stats request");
+            if (!isAuthenticatedRequest(request)) {
+                Logger::warning("Unauthorized bus stats request");
+                request->send(401);
+                return;
+            }
+            String stats = SystemHealth::getBusStatsJson();
+            if (stats.isEmpty()) {
+                sendErrorResponse(request, 500, "Bus statistics too large");
+                return;
+            }
+            sendJsonResponse(request, stats);
+        });
+
     server.on("/api/relay", HTTP_GET, 
         [this](AsyncWebServerRequest* request) {
             Logger::debug("Handling /api/relay GET request");
@@ -350,9 +370,6 @@ void WebServer::setupStaticFiles() {
 }
 
 void WebServer::handleSensorsRequest(AsyncWebServerRequest *request) {
-    String token = extractToken(request);
-    Logger::debug(String("Sensor request token: ") + (token.isEmpty() ? "empty" : "present"));
-    
     if (!isAuthenticatedRequest(request)) {
         // Log the complete request details
         String headers;
@@ -367,17 +384,19 @@ void WebServer::handleSensorsRequest(AsyncWebServerRequest *request) {
     }
     
     try {
-        const auto& sensorList = oneWireManager.getSensorList();
-        AsyncJsonResponse *response = new AsyncJsonResponse(false, 4096);
-        JsonArray array = response->getRoot().to<JsonArray>();
-        
-        Logger::debug("Processing " + String(sensorList.size()) + " sensors for response");
-        
-        for(const auto& sensor : sensorList) {
-            createSensorJson(array, sensor);
+        // Every response shares the current body; the filler keeps it alive
+        // until the response is done, even if a newer body replaces it
+        std::shared_ptr<const String> body = getSensorsBody();
+        if (!body) {
+            sendErrorResponse(request, 500, "Sensor list too large");
+            return;
         }
-        
-        response->setLength();
+        AsyncWebServerResponse* response = request->beginResponse("application/json", body->length(),
+            [body](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                size_t len = std::min(maxLen, (size_t)(body->length() - index));
+                memcpy(buffer, body->c_str() + index, len);
+                return len;
+            });
         request->send(response);
         
     } catch (const std::exception& e) {
@@ -386,35 +405,100 @@ void WebServer::handleSensorsRequest(AsyncWebServerRequest *request) {
     }
 }
 
-JsonObject WebServer::createSensorJson(JsonArray& array, const TemperatureSensor& sensor) {
+// The /api/sensors body, serialized once per registry generation and again
+// only when a name or the display sensor changes. Handlers all run on the
+// AsyncTCP task, so the cached body needs no lock. Null if the document
+// overflowed.
+std::shared_ptr<const String> WebServer::getSensorsBody() {
+    // Read both versions before building, so a change during the build
+    // triggers another one on the next request
+    uint32_t generation = SensorRegistry::getGeneration();
+    uint32_t configVersion = sensorsConfigVersion.load(std::memory_order_acquire);
+    if (sensorsBody && generation == sensorsBodyGeneration && 
+        configVersion == sensorsBodyConfigVersion) {
+        return sensorsBody;
+    }
+    
+    const auto sensorList = SensorRegistry::getSensors();
+    
+    // Per sensor: the object plus the copied address, name and temperatures
+    // (the display sensor repeats its temperature)
+    size_t requiredSize = JSON_ARRAY_SIZE(sensorList.size());
+    requiredSize += sensorList.size() * (JSON_OBJECT_SIZE(9) + 17 + MAX_SENSOR_NAME_LENGTH +
+                                         2 * FixedPoint::TEMP_BUFFER_SIZE);
+    requiredSize += FixedPoint::TEMP_BUFFER_SIZE;
+    
+    DynamicJsonDocument doc(requiredSize);
+    JsonArray array = doc.to<JsonArray>();
+    
+    // Look up the display sensor once per build
+    uint8_t displaySensorAddr[8];
+    PreferencesManager::getDisplaySensor(displaySensorAddr);
+    uint64_t displaySensorKey = SensorRegistry::romKey(displaySensorAddr);
+    
+    for (const auto& sensor : sensorList) {
+        createSensorJson(array, sensor, displaySensorKey);
+    }
+    
+    // A truncated list must not be served, let alone cached
+    if (doc.overflowed()) {
+        Logger::error("Sensors response does not fit in " + String(requiredSize) + " bytes");
+        return nullptr;
+    }
+    
+    String* json = new String();
+    json->reserve(measureJson(doc));
+    serializeJson(doc, *json);
+    
+    sensorsBody.reset(json);
+    sensorsBodyGeneration = generation;
+    sensorsBodyConfigVersion = configVersion;
+    Logger::debug("Rebuilt sensors response: " + String(sensorList.size()) + " sensors, " + 
+                  String(json->length()) + " bytes");
+    return sensorsBody;
+}
+
+// Names and the display sensor are part of the body but not of the registry
+// generation
+void WebServer::onConfigChanged(ConfigKey key, const uint8_t* address) {
+    if (key == ConfigKey::SENSOR_NAME || key == ConfigKey::DISPLAY_SENSOR) {
+        sensorsConfigVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+JsonObject WebServer::createSensorJson(JsonArray& array, const TemperatureSensor& sensor,
+                                       uint64_t displaySensorKey) {
     JsonObject obj = array.createNestedObject();
     
     String addr = addressToString(sensor.address);
     obj["address"] = addr;
     
-    String name = PreferencesManager::getSensorName(sensor.address);
+    String name = SensorRegistry::getSensorName(sensor.address);
     if (name.length() > 0) {
         obj["name"] = name;
     }
     
-    obj["temperature"] = sensor.valid ? sensor.temperature : DEVICE_DISCONNECTED_C;
+    // The response is serialized after this returns, so the value is copied
+    char tempStr[FixedPoint::TEMP_BUFFER_SIZE];
+    FixedPoint::formatTemperature(sensor.valid ? sensor.temperatureRaw : FixedPoint::RAW_DISCONNECTED,
+                                  FixedPoint::JSON_DECIMALS, tempStr);
+    obj["temperature"] = serialized(String(tempStr));
+    
+    // Unfiltered sample alongside the filtered value
+    FixedPoint::formatTemperature(sensor.valid ? sensor.sampleRaw : FixedPoint::RAW_DISCONNECTED,
+                                  FixedPoint::JSON_DECIMALS, tempStr);
+    obj["rawTemperature"] = serialized(String(tempStr));
+    obj["filter"] = SensorFilter::typeName(static_cast<FilterType>(sensor.filterType));
     obj["valid"] = sensor.valid;
     obj["lastReadTime"] = sensor.lastReadTime;
     
     // Check if this sensor is the currently selected BabelSensor
-    uint8_t displaySensorAddr[8];
-    PreferencesManager::getDisplaySensor(displaySensorAddr);
-    if (memcmp(sensor.address, displaySensorAddr, 8) == 0) {
+    bool isDisplaySensor = SensorRegistry::romKey(sensor.address) == displaySensorKey;
+    if (isDisplaySensor) {
         obj["isBabelSensor"] = true;
-        obj["babelTemperature"] = sensor.temperature;  // Add this alias for compatibility
+        obj["babelTemperature"] = obj["temperature"];  // Add this alias for compatibility
     }
     
-    Logger::debug("Added sensor: " + addr + 
-                 (name.length() > 0 ? " (" + name + ")" : "") +
-                 ", temp: " + String(sensor.temperature, 2) + 
-                 ", valid: " + String(sensor.valid) +
-                 ", babel: " + String(memcmp(sensor.address, displaySensorAddr, 8) == 0));
-                 
     return obj;
 }
 
@@ -18,7 +18,7 @@
 #include "NtpManager.h"
 #include "WebServer.h"
 
-WebServer webServer(OneWireTask::getManager());
+WebServer webServer;
 
 
 void prepareNetworkForSsl() {